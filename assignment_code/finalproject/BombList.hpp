@@ -0,0 +1,91 @@
+#ifndef BOMB_LIST_H_
+#define BOMB_LIST_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace GLOO {
+// Bombs of an ExplodingSystem, stored structure-of-arrays and kept sorted by
+// start time. A bomb pushes during [start, start + epsilon); once that
+// window has passed it is removed by RetireExpired, so the list only holds
+// bombs that are live or still to come.
+struct BombList {
+  std::vector<float> start;
+  std::vector<float> epsilon;
+  std::vector<float> expansion_rate;
+  std::vector<float> center_x, center_y, center_z;
+  // Attenuation a * d^2 + b * d + c with distance d from the center.
+  std::vector<float> coef_a, coef_b, coef_c;
+
+  size_t Size() const {
+    return start.size();
+  }
+
+  void Clear() {
+    for (auto channel : Channels()) {
+      channel->clear();
+    }
+  }
+
+  void Add(float start_time,
+           float duration,
+           float rate,
+           const glm::vec3& center,
+           const glm::vec3& coef) {
+    // Bombs mostly arrive in time order, so this is usually an append.
+    size_t index =
+        std::upper_bound(start.begin(), start.end(), start_time) - start.begin();
+    const float values[kNumChannels] = {start_time, duration, rate,
+                                        center.x,   center.y, center.z,
+                                        coef.x,     coef.y,   coef.z};
+    auto channels = Channels();
+    for (size_t c = 0; c < channels.size(); c++) {
+      channels[c]->insert(channels[c]->begin() + index, values[c]);
+    }
+  }
+
+  // Removes the bombs whose window ended at or before time, keeping the
+  // rest in order. time must not go backwards between calls (other than
+  // through Clear), since retired bombs are gone for good.
+  void RetireExpired(float time) {
+    size_t kept = 0;
+    auto channels = Channels();
+    for (size_t i = 0; i < Size(); i++) {
+      if (start[i] + epsilon[i] <= time)
+        continue;
+      if (kept != i) {
+        for (auto channel : channels) {
+          (*channel)[kept] = (*channel)[i];
+        }
+      }
+      kept++;
+    }
+    for (auto channel : channels) {
+      channel->resize(kept);
+    }
+  }
+
+  // Number of bombs with start <= time; only those can be live at time.
+  size_t NumStarted(float time) const {
+    return std::upper_bound(start.begin(), start.end(), time) - start.begin();
+  }
+
+  glm::vec3 GetCenter(size_t i) const {
+    return glm::vec3(center_x[i], center_y[i], center_z[i]);
+  }
+
+ private:
+  static const size_t kNumChannels = 9;
+
+  std::array<std::vector<float>*, kNumChannels> Channels() {
+    return {{&start, &epsilon, &expansion_rate, &center_x, &center_y,
+             &center_z, &coef_a, &coef_b, &coef_c}};
+  }
+};
+}  // namespace GLOO
+
+#endif
@@ -3,23 +3,77 @@
 #include "gloo/components/ShadingComponent.hpp"
 #include "gloo/components/MaterialComponent.hpp"
 #include "IntegratorFactory.hpp"
+#include "gloo/AsyncLoader.hpp"
 #include "gloo/InputManager.hpp"
 #include "gloo/MeshLoader.hpp"
 #include "gloo/debug/PrimitiveFactory.hpp"
+#include "gloo/Profiler.hpp"
 #include <fstream>
+#include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <limits>
 
 namespace GLOO {
-    BunnyNode::BunnyNode(float integration_step): 
-        integration_step_(integration_step) {
+    BunnyNode::BunnyNode(float integration_step, IntegratorType integrator_type): 
+        integration_step_(integration_step), integrator_type_(integrator_type) {
         Init();
     }
 
     void BunnyNode::Init() {
+        // Loading the mesh, computing its normals and cutting it into
+        // fragments happen on a loader thread; the rest needs GL and is
+        // posted back to the main thread. If the node is gone by then, the
+        // result is dropped. A failed load is reported and leaves the node
+        // empty.
+        int triangle_scale = triangle_scale_;
+        std::weak_ptr<bool> alive = alive_;
+        AsyncLoader::GetInstance().Submit([this, triangle_scale, alive]() {
+            std::shared_ptr<LoadedBunny> bunny;
+            try {
+                bunny = LoadBunny(triangle_scale);
+            } catch (const std::exception& e) {
+                std::cerr << "ERROR: " << e.what() << std::endl;
+                return;
+            }
+            AsyncLoader::GetInstance().PostToMainThread([this, bunny, alive]() {
+                if (!alive.expired()) FinishLoading(*bunny);
+            });
+        });
+        loaded_ = false;
+    }
+
+    std::unique_ptr<BunnyNode::LoadedBunny> BunnyNode::LoadBunny(int triangle_scale) {
+        auto bunny = make_unique<LoadedBunny>();
+        bool success;
+        // Welded and cache-ordered; the fragments do not depend on the order.
+        MeshLoadOptions options;
+        options.optimize = true;
+        auto mesh = MeshLoader::LoadArrays("bunny_1k.obj", success, options);
+        if (!success || !mesh.positions || !mesh.indices) {
+            throw std::runtime_error("Cannot load the bunny mesh!");
+        }
+        bunny->positions = std::move(*mesh.positions);
+        bunny->indices = std::move(*mesh.indices);
+        bunny->normals = ComputeNormals(bunny->positions, bunny->indices);
+        bunny->fragment_geometry = BuildFragments(bunny->positions, bunny->normals, bunny->indices, triangle_scale,
+                                                  bunny->particle_state, bunny->particles_initial_normal);
+        return bunny;
+    }
+
+    void BunnyNode::FinishLoading(LoadedBunny& bunny) {
+        bunny_positions_ = std::move(bunny.positions);
+        bunny_normals_ = std::move(bunny.normals);
+        bunny_indices_ = std::move(bunny.indices);
         InitBunny();
-        InitParticle();
+
+        particle_state_ = std::move(bunny.particle_state);
+        particles_initial_normal_ = std::move(bunny.particles_initial_normal);
+        fragment_geometry_ = bunny.fragment_geometry;
+        ResetParticles();
         InitTriangle();
         InitSystem();
+        loaded_ = true;
     }
 
     void BunnyNode::InitBunny() {
@@ -28,12 +82,10 @@ namespace GLOO {
         bunny_material_ = std::make_shared<Material>(glm::vec3(1.f, 1.f, 1.f),
                                                     glm::vec3(1.f, 1.f, 1.f),
                                                     glm::vec3(0.4f, 0.4f, 0.4f), 20.0f);
-        std::string bunny_path = GetAssetDir() + "bunny_1k.obj";
-        bunny_mesh_ = MeshLoader::Import(bunny_path).vertex_obj;
-        bunny_positions_ = bunny_mesh_->GetPositions();
-        bunny_indices_ = bunny_mesh_->GetIndices();
-        SetNormals();
-        bunny_normals_ = bunny_mesh_->GetNormals();
+        bunny_mesh_ = std::make_shared<VertexObject>();
+        bunny_mesh_->UpdatePositions(make_unique<PositionArray>(bunny_positions_));
+        bunny_mesh_->UpdateNormals(make_unique<NormalArray>(bunny_normals_));
+        bunny_mesh_->UpdateIndices(make_unique<IndexArray>(bunny_indices_));
         bunny_scale_ = glm::vec3(1.f);
 
         auto bunny_node = make_unique<SceneNode>();
@@ -46,59 +98,71 @@ namespace GLOO {
     }
 
     void BunnyNode::InitParticle() {
-        particle_state_.positions = {};
-        particle_state_.velocities = {};
-
-        for (int i = 0; i < bunny_indices_.size(); i += 3) {
-            auto pos1 = bunny_positions_[bunny_indices_[i]];
-            auto pos2 = bunny_positions_[bunny_indices_[i + 1]];
-            auto pos3 = bunny_positions_[bunny_indices_[i + 2]];
+        fragment_geometry_ = BuildFragments(bunny_positions_, bunny_normals_, bunny_indices_, triangle_scale_,
+                                            particle_state_, particles_initial_normal_);
+        ResetParticles();
+    }
 
-            auto nor1 = bunny_normals_[bunny_indices_[i]];
-            auto nor2 = bunny_normals_[bunny_indices_[i + 1]];
-            auto nor3 = bunny_normals_[bunny_indices_[i + 2]];
+    void BunnyNode::ResetParticles() {
+        particle_system_.SetGeometry(fragment_geometry_);
+        workspace_.Invalidate();
+        isSmashed.assign(particle_state_.Size(), false);
+        exploding_ = false;
+    }
 
-            for (int i1 = 0; i1 < triangle_scale_; i1++) {
-                for (int i2 = 0; i2 < triangle_scale_ - i1; i2++) {
+    std::shared_ptr<FragmentGeometry> BunnyNode::BuildFragments(const PositionArray& bunny_positions,
+                                                                const NormalArray& bunny_normals,
+                                                                const IndexArray& bunny_indices,
+                                                                int triangle_scale,
+                                                                FragmentState& particle_state,
+                                                                NormalArray& particles_initial_normal) {
+        // Vertex triples are collected first and then turned into rigid
+        // fragments: the state keeps one center and orientation per triangle,
+        // the geometry keeps the vertex offsets.
+        float triangle_multiplier = 1.f / float(triangle_scale);
+        PositionArray positions;
+        particles_initial_normal.clear();
+
+        for (int i = 0; i < bunny_indices.size(); i += 3) {
+            auto pos1 = bunny_positions[bunny_indices[i]];
+            auto pos2 = bunny_positions[bunny_indices[i + 1]];
+            auto pos3 = bunny_positions[bunny_indices[i + 2]];
+
+            auto nor1 = bunny_normals[bunny_indices[i]];
+            auto nor2 = bunny_normals[bunny_indices[i + 1]];
+            auto nor3 = bunny_normals[bunny_indices[i + 2]];
+
+            for (int i1 = 0; i1 < triangle_scale; i1++) {
+                for (int i2 = 0; i2 < triangle_scale - i1; i2++) {
                     float f1 = float(i1);
                     float f2 = float(i2);
-                    float f3 = float(triangle_scale_) - f1 - f2;
+                    float f3 = float(triangle_scale) - f1 - f2;
 
-                    auto pos = triangle_multiplier_ * (f1 * pos1 + f2 * pos2 + f3 * pos3);
-                    auto nor = triangle_multiplier_ * (f1 * nor1 + f2 * nor2 + f3 * nor3);
+                    auto pos = triangle_multiplier * (f1 * pos1 + f2 * pos2 + f3 * pos3);
+                    auto nor = triangle_multiplier * (f1 * nor1 + f2 * nor2 + f3 * nor3);
 
-                    particle_state_.positions.push_back(pos);
-                    particle_state_.positions.push_back(pos + triangle_multiplier_ * (pos1 - pos3));
-                    particle_state_.positions.push_back(pos + triangle_multiplier_ * (pos2 - pos3));
+                    positions.push_back(pos);
+                    positions.push_back(pos + triangle_multiplier * (pos1 - pos3));
+                    positions.push_back(pos + triangle_multiplier * (pos2 - pos3));
 
-                    particles_initial_normal_.push_back(glm::normalize(nor));
-                    particles_initial_normal_.push_back(glm::normalize(nor + triangle_multiplier_ * (nor1 - nor3)));
-                    particles_initial_normal_.push_back(glm::normalize(nor + triangle_multiplier_ * (nor2 - nor3)));
+                    particles_initial_normal.push_back(glm::normalize(nor));
+                    particles_initial_normal.push_back(glm::normalize(nor + triangle_multiplier * (nor1 - nor3)));
+                    particles_initial_normal.push_back(glm::normalize(nor + triangle_multiplier * (nor2 - nor3)));
 
-                    particle_state_.velocities.push_back(glm::vec3(0.f,0.f,0.f));
-                    particle_state_.velocities.push_back(glm::vec3(0.f,0.f,0.f));
-                    particle_state_.velocities.push_back(glm::vec3(0.f,0.f,0.f));
                     if (f3 > 1.1f) {
-                        particle_state_.positions.push_back(pos + triangle_multiplier_ * (pos1 + pos2 - 2.f * pos3));
-                        particle_state_.positions.push_back(pos + triangle_multiplier_ * (pos1 - pos3));
-                        particle_state_.positions.push_back(pos + triangle_multiplier_ * (pos2 - pos3));
+                        positions.push_back(pos + triangle_multiplier * (pos1 + pos2 - 2.f * pos3));
+                        positions.push_back(pos + triangle_multiplier * (pos1 - pos3));
+                        positions.push_back(pos + triangle_multiplier * (pos2 - pos3));
 
-                        particles_initial_normal_.push_back(glm::normalize(nor + triangle_multiplier_ * (nor1 + nor2 - 2.f * nor3)));
-                        particles_initial_normal_.push_back(glm::normalize(nor + triangle_multiplier_ * (nor1 - nor3)));
-                        particles_initial_normal_.push_back(glm::normalize(nor + triangle_multiplier_ * (nor2 - nor3)));
+                        particles_initial_normal.push_back(glm::normalize(nor + triangle_multiplier * (nor1 + nor2 - 2.f * nor3)));
+                        particles_initial_normal.push_back(glm::normalize(nor + triangle_multiplier * (nor1 - nor3)));
+                        particles_initial_normal.push_back(glm::normalize(nor + triangle_multiplier * (nor2 - nor3)));
 
-                        particle_state_.velocities.push_back(glm::vec3(0.f,0.f,0.f));
-                        particle_state_.velocities.push_back(glm::vec3(0.f,0.f,0.f));
-                        particle_state_.velocities.push_back(glm::vec3(0.f,0.f,0.f));
                     } 
                 }
             }
         }
-        for(int i=0; i< particle_state_.positions.size(); i+=3)
-        {
-            isSmashed.push_back(false);
-        }
-        exploding_ = false;
+        return std::make_shared<FragmentGeometry>(FragmentGeometry::FromTriangles(positions, particle_state));
     }
 
     void BunnyNode::InitTriangle() {
@@ -107,56 +171,44 @@ namespace GLOO {
                                                     glm::vec3(1.f, 1.f, 1.f),
                                                     glm::vec3(0.4f, 0.4f, 0.4f), 20.0f);
 
-        for (int i = 0; i < particles_initial_normal_.size(); i += 3) {
-            auto triangle_node = make_unique<SceneNode>();
-            triangle_node->CreateComponent<ShadingComponent>(phong_shader_);
-            triangle_node->CreateComponent<MaterialComponent>(triangle_material_);
-
-            auto triangle_mesh = std::make_shared<VertexObject>();
-
-            auto positions = make_unique<PositionArray>();
-            positions->push_back(particle_state_.positions[i]);
-            positions->push_back(particle_state_.positions[i + 1]);
-            positions->push_back(particle_state_.positions[i + 2]);
-
-            auto normals = make_unique<NormalArray>();
-            normals->push_back(particles_initial_normal_[i]);
-            normals->push_back(particles_initial_normal_[i + 1]);
-            normals->push_back(particles_initial_normal_[i + 2]);
-
-            auto indices = make_unique<IndexArray>();
-            indices->push_back(0);
-            indices->push_back(1);
-            indices->push_back(2);
-
-            triangle_mesh->UpdatePositions(std::move(positions));
-            triangle_mesh->UpdateNormals(std::move(normals));
-            triangle_mesh->UpdateIndices(std::move(indices));
-
-            triangle_node->CreateComponent<RenderingComponent>(triangle_mesh).SetDrawMode(DrawMode::Triangles);
-            triangle_node->GetTransform().SetScale(bunny_scale_);
-            triangle_node->SetActive(false);
-
-            triangle_pointers_.push_back(triangle_node.get());
-            AddChild(std::move(triangle_node));
-        }
+        // All fragments share one mesh and one draw call.
+        auto fragment_batch = make_unique<FragmentBatchNode>(phong_shader_, triangle_material_, fragment_geometry_,
+                                                             particle_state_, particles_initial_normal_);
+        fragment_batch->GetTransform().SetScale(bunny_scale_);
+        fragment_batch->SetActive(false);
+        fragment_batch_ = fragment_batch.get();
+        AddChild(std::move(fragment_batch));
     }
 
     void BunnyNode::InitSystem() {
-        integrator_ = IntegratorFactory::CreateIntegrator<ParticleSystemBase, ParticleState>();
+        integrator_ = IntegratorFactory::CreateIntegrator<FragmentSystemBase, FragmentState>(integrator_type_);
         particle_system_ = ExplodingSystem();
+        particle_system_.SetGeometry(fragment_geometry_);
     }
 
     void BunnyNode::Update(double delta_time) {
+        // FinishLoading has not run yet, or the load failed.
+        if (!loaded_) return;
         double slow_factor = 1;
         double delta_time_=delta_time / slow_factor;
         if (exploding_) {
             int num_steps = (delta_time_ + carrier_time_step_)/integration_step_;
             carrier_time_step_ = delta_time_ + carrier_time_step_ - float(num_steps * integration_step_);
-            for (int i = 0; i < num_steps; i++) {
-                Advance(used_time_ + float(i * integration_step_));
+            float frame_time = float(num_steps * integration_step_);
+            // Bombs that finished pushing no longer affect anything from here on.
+            particle_system_.RetireExpired(used_time_);
+            if (integrator_->IsAdaptive() && num_steps > 0 && !BallMayHit(used_time_, used_time_ + frame_time)) {
+                // Nothing can collide this frame, so let the integrator pick
+                // its own steps across the whole of it.
+                ScopedCpuTimer timer("Physics integrate");
+                integrator_->Integrate(particle_system_, particle_state_, used_time_, frame_time, workspace_);
+                particle_state_.NormalizeOrientations();
+            } else {
+                for (int i = 0; i < num_steps; i++) {
+                    Advance(used_time_ + float(i * integration_step_));
+                }
             }
-            used_time_ += float(num_steps * integration_step_);
+            used_time_ += frame_time;
             SetPositions();
         }
 
@@ -167,7 +219,6 @@ namespace GLOO {
                 if (exploding_) {
                     InitParticle();
                     SetPositions();
-                    SetNormals();
                     ResetExplosionActive();
                 }
             }
@@ -185,17 +236,47 @@ namespace GLOO {
     }
 
     void BunnyNode::Advance(float start_time) {
-        for (int i = 0; i < particle_state_.positions.size(); i+=3) {
-            if(isSmashed[i/3]) continue;
-            std::pair<bool, std::pair<glm::vec3, glm::vec3>> result = CheckIntersect(i, start_time);
-            if(result.first && glm::length(result.second.second) > 0.001){
-                isSmashed[i/3] = true;
-                particle_state_.velocities[i] += ball_velocity;
-                particle_state_.velocities[i+1] += ball_velocity;
-                particle_state_.velocities[i+2] += ball_velocity;
-                glm::vec3 face_normal = glm::normalize(result.second.second);
-                float multiplier = pow(abs(glm::dot(face_normal, ball_velocity / ball_speed)), multiplier_exponent) * ball_speed;
-                particle_system_.AddBomb(start_time, result.second.first, multiplier);
+        ScopedCpuTimer timer("Physics substep");
+        // Broadphase: only unsmashed fragments whose center can come within
+        // reach of the ball during this step get the narrow-phase test.
+        // Smashed ones never collide again, so they are left out of the grid
+        // and of the speed bound. Candidates come back in index order, so hits
+        // are processed in the same order as a full scan would.
+        unsmashed_.clear();
+        unsmashed_x_.clear();
+        unsmashed_y_.clear();
+        unsmashed_z_.clear();
+        float max_speed = 0.f;
+        for (int i = 0; i < particle_state_.Size(); i++) {
+            if (isSmashed[i]) continue;
+            glm::vec3 p = particle_state_.GetPosition(i);
+            unsmashed_.push_back(uint32_t(i));
+            unsmashed_x_.push_back(p.x);
+            unsmashed_y_.push_back(p.y);
+            unsmashed_z_.push_back(p.z);
+            max_speed = std::max(max_speed, glm::length(particle_state_.GetVelocity(i)));
+        }
+        collision_grid_.Build(unsmashed_x_.data(), unsmashed_y_.data(), unsmashed_z_.data(), unsmashed_.size(),
+                              std::max(ball_radius, 2.f * fragment_geometry_->max_radius));
+        glm::vec3 ball_from = ball_start + start_time * ball_velocity;
+        glm::vec3 ball_to = ball_from + integration_step_ * ball_velocity;
+        glm::vec3 reach(ball_radius + fragment_geometry_->max_radius + max_speed * integration_step_);
+        collision_candidates_.clear();
+        collision_grid_.Query(glm::min(ball_from, ball_to) - reach, glm::max(ball_from, ball_to) + reach, collision_candidates_);
+        for (uint32_t candidate : collision_candidates_) {
+            uint32_t i = unsmashed_[candidate];
+            SweptSphereHit hit;
+            if(CheckIntersect(i, start_time, integration_step_, hit)){
+                workspace_.Invalidate();
+                isSmashed[i] = true;
+                // The ball's velocity is imparted hit.time into the step.
+                // Moving the fragment back by hit.time * ball_velocity lets
+                // the integrator run the whole step at the new velocity and
+                // still end where a mid-step impulse would have put it.
+                particle_state_.SetVelocity(i, particle_state_.GetVelocity(i) + ball_velocity);
+                particle_state_.SetPosition(i, particle_state_.GetPosition(i) - hit.time * ball_velocity);
+                float multiplier = pow(abs(glm::dot(hit.normal, ball_velocity / ball_speed)), multiplier_exponent) * ball_speed;
+                particle_system_.AddBomb(start_time + hit.time, hit.point, multiplier);
                 // std::cout << start_time << std::endl;
                   // Create Explosion Center
                 // auto expl_center = std::shared_ptr<VertexObject>(PrimitiveFactory::CreateSphere(0.01f, 20, 20));
@@ -210,52 +291,51 @@ namespace GLOO {
                 // expl_node->GetTransform().SetPosition(result.second.first);
                 // AddChild(std::move(expl_node));
             }
-            particle_state_.positions[i] += result.second.second;
-            particle_state_.positions[i+1] += result.second.second;
-            particle_state_.positions[i+2] += result.second.second;
         }
 
-        auto next_state = integrator_->Integrate(particle_system_, particle_state_, start_time, integration_step_);
-        particle_state_ = next_state;
+        integrator_->Integrate(particle_system_, particle_state_, start_time, integration_step_, workspace_);
+        particle_state_.NormalizeOrientations();
     }
 
     void BunnyNode::SetPositions() {
-        for (int i = 0; i < particle_state_.positions.size()/3; i++) {
-            auto positions = make_unique<PositionArray>();
-            positions->push_back(particle_state_.positions[3 * i]);
-            positions->push_back(particle_state_.positions[3 * i + 1]);
-            positions->push_back(particle_state_.positions[3 * i + 2]);
-            triangle_pointers_[i]->GetComponentPtr<RenderingComponent>()->GetVertexObjectPtr()->UpdatePositions(std::move(positions));
+        ScopedCpuTimer timer("Fragment vertices");
+        // Fragments that flew past the retire distance stay hidden until the
+        // next reset.
+        float retire_distance2 = fragment_retire_distance_ * fragment_retire_distance_;
+        for (size_t i = 0; i < particle_state_.Size(); i++) {
+            glm::vec3 p = particle_state_.GetPosition(i);
+            if (glm::dot(p, p) > retire_distance2) fragment_batch_->SetFragmentVisible(i, false);
         }
+        fragment_batch_->SetFragments(particle_state_);
     }
 
-    void BunnyNode::SetNormals() {
+    NormalArray BunnyNode::ComputeNormals(const PositionArray& bunny_positions, const IndexArray& bunny_indices) {
         std::vector<std::vector<glm::vec3>> normal_around_vertices;
-        for (int i = 0; i < bunny_positions_.size(); i++) {
+        for (int i = 0; i < bunny_positions.size(); i++) {
             normal_around_vertices.push_back(std::vector<glm::vec3>());
         }
 
-        for (int i = 0; i < bunny_indices_.size(); i += 3) {
-            auto vertex1 = bunny_positions_[bunny_indices_[i]];
-            auto vertex2 = bunny_positions_[bunny_indices_[i + 1]];
-            auto vertex3 = bunny_positions_[bunny_indices_[i + 2]];
+        for (int i = 0; i < bunny_indices.size(); i += 3) {
+            auto vertex1 = bunny_positions[bunny_indices[i]];
+            auto vertex2 = bunny_positions[bunny_indices[i + 1]];
+            auto vertex3 = bunny_positions[bunny_indices[i + 2]];
             auto cross_product = glm::cross(vertex3 - vertex2, vertex1 - vertex2);
             
-            normal_around_vertices[bunny_indices_[i]].push_back(cross_product);
-            normal_around_vertices[bunny_indices_[i + 1]].push_back(cross_product);
-            normal_around_vertices[bunny_indices_[i + 2]].push_back(cross_product);
+            normal_around_vertices[bunny_indices[i]].push_back(cross_product);
+            normal_around_vertices[bunny_indices[i + 1]].push_back(cross_product);
+            normal_around_vertices[bunny_indices[i + 2]].push_back(cross_product);
         }
 
-        auto normals = make_unique<NormalArray>();
-        for (int i = 0; i < bunny_positions_.size(); i++) {
+        NormalArray normals;
+        for (int i = 0; i < bunny_positions.size(); i++) {
             glm::vec3 normal(0.f, 0.f, 0.f);
             auto normal_around_vertex = normal_around_vertices[i];
             for (int j = 0; j < normal_around_vertex.size(); j++) {
             normal += normal_around_vertex[j];
             }
-            normals->push_back(glm::normalize(normal));
+            normals.push_back(glm::normalize(normal));
         }
-        bunny_mesh_->UpdateNormals(std::move(normals));
+        return normals;
     }
 
     // void BunnyNode::SetColors() {
@@ -269,9 +349,7 @@ namespace GLOO {
 
     void BunnyNode::MakeExplosionActive() {
         bunny_pointer_->SetActive(false);
-        for (auto triangle_pointer: triangle_pointers_) {
-            triangle_pointer->SetActive(true);
-        }
+        fragment_batch_->SetActive(true);
         used_time_ = 0.0f;
     }
 
@@ -279,64 +357,53 @@ namespace GLOO {
         bunny_pointer_->SetActive(true);
         particle_system_.ClearBomb();
         for(int i=0;i<isSmashed.size();i++) isSmashed[i] = false;
-        for (auto triangle_pointer: triangle_pointers_) {
-            triangle_pointer->SetActive(false);
-        }
+        fragment_batch_->SetAllFragmentsVisible(true);
+        fragment_batch_->SetActive(false);
     }
 
-    // retunr {sphere intersect the triangle with vertices p1,p2,p3 or not {point of contact, displacement of the triangle to avoid overlap}}
-    std::pair<bool, std::pair<glm::vec3, glm::vec3>> BunnyNode::CheckIntersect(int idx, float time) {
-        glm::vec3 p1 = particle_state_.positions[idx];
-        glm::vec3 p2 = particle_state_.positions[idx+1];
-        glm::vec3 p3 = particle_state_.positions[idx+2];
-        glm::vec3 o = ball_start + time * ball_velocity;
-
-        glm::vec3 v = o - p3;
-        glm::vec3 v1 = p1-p3;
-        glm::vec3 v2 = p2-p3;
-
-        float q11 = glm::dot(v1, v1);
-        float q12 = glm::dot(v1, v2);
-        float q22 = glm::dot(v2, v2);
-        glm::mat2 Q =glm::mat2(q11, q12, q12, q22);
-        glm::vec2 coefs = glm::inverse(Q) * glm::vec2(glm::dot(v, v1), glm::dot(v, v2));
-        float r1 = coefs[0];
-        float r2 = coefs[1];
-        glm::vec3 plane_vec = r1 * v1 + r2 * v2;
-        glm::vec3 perp_vec = v - plane_vec;
-        float perp_length = glm::length(perp_vec);
-
-        if (perp_length > ball_radius) return {false, {glm::vec3(0.f,0.f,0.f),glm::vec3(0.f,0.f,0.f)}};
-
-        if(r1 >= 0 && r2 >= 0 && r1+r2 <= 1) return {true, {p3+plane_vec, (1 - ball_radius / perp_length)  * perp_vec}};
-
-        // calc closest point to sphere if any (must be on edge)
-        auto temp_data = CalcClosest(p1, p2, o);
-        float min_dist = temp_data.second;
-        glm::vec3 hit_position = temp_data.first;
-        temp_data = CalcClosest(p2,p3,o);
-        if(temp_data.second < min_dist){
-            min_dist = temp_data.second;
-            hit_position = temp_data.first;
+    // Conservative test of whether the ball can touch any intact fragment in
+    // [start_time, end_time]: the ball's swept box against the box around the
+    // fragment centers, grown by the fragment size and by how far the fastest
+    // fragment can travel meanwhile.
+    bool BunnyNode::BallMayHit(float start_time, float end_time) const {
+        glm::vec3 fragment_min(std::numeric_limits<float>::max());
+        glm::vec3 fragment_max(-std::numeric_limits<float>::max());
+        float max_speed = 0.f;
+        bool any_intact = false;
+        for (int i = 0; i < particle_state_.Size(); i++) {
+            if (isSmashed[i]) continue;
+            any_intact = true;
+            glm::vec3 p = particle_state_.GetPosition(i);
+            fragment_min = glm::min(fragment_min, p);
+            fragment_max = glm::max(fragment_max, p);
+            max_speed = std::max(max_speed, glm::length(particle_state_.GetVelocity(i)));
         }
-        temp_data = CalcClosest(p3,p1,o);
-        if(temp_data.second < min_dist){
-            min_dist = temp_data.second;
-            hit_position = temp_data.first;
+        if (!any_intact) return false;
+        float reach = max_speed * (end_time - start_time) + ball_radius + fragment_geometry_->max_radius;
+        glm::vec3 ball_a = ball_start + start_time * ball_velocity;
+        glm::vec3 ball_b = ball_start + end_time * ball_velocity;
+        glm::vec3 ball_min = glm::min(ball_a, ball_b) - glm::vec3(reach);
+        glm::vec3 ball_max = glm::max(ball_a, ball_b) + glm::vec3(reach);
+        for (int axis = 0; axis < 3; axis++) {
+            if (ball_min[axis] > fragment_max[axis] || fragment_min[axis] > ball_max[axis]) return false;
         }
-        if(min_dist > ball_radius) return {false, {glm::vec3(0.f,0.f,0.f),glm::vec3(0.f,0.f,0.f)}};
-        float last_perp_dist = pow(ball_radius * ball_radius - glm::dot(plane_vec, plane_vec), 0.5);
-        return {true, {hit_position, (1 - last_perp_dist / perp_length) * perp_vec}};
+        return true;
     }
 
-    std::pair<glm::vec3, float> BunnyNode::CalcClosest(glm::vec3 a, glm::vec3 b, glm::vec3 c){
-        glm::vec3 ab = b-a;
-        float l = glm::length(ab);
-        ab = (1.0f/ l) * ab;
-        float d = glm::dot(c, ab);
-        if (d<0) d=0;
-        if(d>l) d=l;
-        glm::vec3 landing = a + d * ab;
-        return {landing, glm::length(c - landing)};
+    // Sweeps the ball over [start_time, start_time + dt] against fragment
+    // idx, which keeps moving with its current velocity meanwhile (its spin
+    // within one step is ignored). On a hit, hit.time is relative to
+    // start_time and hit.point is where the two touch at that time.
+    bool BunnyNode::CheckIntersect(int idx, float start_time, float dt, SweptSphereHit& hit) {
+        glm::vec3 vertices[3];
+        fragment_geometry_->GetVertices(particle_state_, idx, vertices);
+        glm::vec3 o = ball_start + start_time * ball_velocity;
+        glm::vec3 fragment_velocity = particle_state_.GetVelocity(idx);
+        if (!SweepSphereTriangle(o, ball_radius, ball_velocity - fragment_velocity, dt,
+                                 vertices[0], vertices[1], vertices[2], hit)) {
+            return false;
+        }
+        hit.point += hit.time * fragment_velocity;
+        return true;
     }
 }
\ No newline at end of file
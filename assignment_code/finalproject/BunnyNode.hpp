@@ -3,42 +3,77 @@
 
 #include "gloo/SceneNode.hpp"
 #include "IntegratorBase.hpp"
+#include "IntegratorFactory.hpp"
 #include "ExplodingSystem.hpp"
-#include "ParticleState.hpp"
+#include "FragmentState.hpp"
+#include "FragmentGeometry.hpp"
+#include "FragmentBatchNode.hpp"
+#include "UniformGrid.hpp"
+#include "SweptSphere.hpp"
 #include "gloo/shaders/MyShader.hpp"
 #include "gloo/shaders/PhongShader.hpp"
 #include "gloo/Material.hpp"
 #include "gloo/VertexObject.hpp"
 
+#include <memory>
+
 namespace GLOO {
     class BunnyNode : public SceneNode {
         public:
-        BunnyNode(float integration_step);
+        BunnyNode(float integration_step, IntegratorType integrator_type = IntegratorType::RK4);
         void Update(double delta_time) override;
 
         private:
+        // What the bunny needs from the CPU side before anything can be
+        // sent to GL; built off the main thread by LoadBunny.
+        struct LoadedBunny {
+            PositionArray positions;
+            NormalArray normals;
+            IndexArray indices;
+            FragmentState particle_state;
+            NormalArray particles_initial_normal;
+            std::shared_ptr<FragmentGeometry> fragment_geometry;
+        };
+
         void Init();
+        static std::unique_ptr<LoadedBunny> LoadBunny(int triangle_scale);
+        void FinishLoading(LoadedBunny& bunny);
         void InitParticle();
+        void ResetParticles();
         void InitBunny();
         void InitTriangle();
         void InitSystem();
         void Advance(float start_time);
         void SetPositions();
-        void SetNormals();
+        static NormalArray ComputeNormals(const PositionArray& bunny_positions, const IndexArray& bunny_indices);
+        static std::shared_ptr<FragmentGeometry> BuildFragments(const PositionArray& bunny_positions,
+                                                                const NormalArray& bunny_normals,
+                                                                const IndexArray& bunny_indices,
+                                                                int triangle_scale,
+                                                                FragmentState& particle_state,
+                                                                NormalArray& particles_initial_normal);
         // void SetColors();
         void MakeExplosionActive();
         void ResetExplosionActive();
 
-        std::unique_ptr<IntegratorBase<ParticleSystemBase, ParticleState>> integrator_;
-        ParticleState particle_state_;
+        std::unique_ptr<IntegratorBase<FragmentSystemBase, FragmentState>> integrator_;
+        FragmentState particle_state_;
+        std::shared_ptr<FragmentGeometry> fragment_geometry_;
+        IntegratorWorkspace<FragmentState> workspace_;
         NormalArray particles_initial_normal_;
         ExplodingSystem particle_system_;
 
         // step
         float integration_step_;
+        IntegratorType integrator_type_;
         float carrier_time_step_ = 0.f;
         float used_time_ = 0.f;
 
+        // loading
+        bool loaded_;
+        // Expires with the node, so that a load finishing later is dropped.
+        std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
+
         // components
         SceneNode* bunny_pointer_;
         PositionArray bunny_positions_;
@@ -51,9 +86,12 @@ namespace GLOO {
         std::shared_ptr<Material> bunny_material_;
         glm::vec3 bunny_scale_;
 
-        std::vector<SceneNode*> triangle_pointers_;
+        FragmentBatchNode* fragment_batch_;
         std::shared_ptr<PhongShader> phong_shader_;
         std::shared_ptr<Material> triangle_material_;
+        // distance from the origin past which a fragment is no longer drawn;
+        // from the default camera it is well under a pixel by then
+        float fragment_retire_distance_ = 20.f;
 
         bool exploding_;
         
@@ -67,9 +105,14 @@ namespace GLOO {
         float ball_speed = glm::length(ball_velocity);
 
         // ball - bunny calculation
-        std::pair<bool, std::pair<glm::vec3, glm::vec3>> CheckIntersect(int idx, float time);
-        std::pair<glm::vec3, float> CalcClosest(glm::vec3 a, glm::vec3 b, glm::vec3 c);
+        bool CheckIntersect(int idx, float start_time, float dt, SweptSphereHit& hit);
+        bool BallMayHit(float start_time, float end_time) const;
         std::vector<bool> isSmashed;
+        UniformGrid collision_grid_;
+        std::vector<uint32_t> collision_candidates_;
+        // Unsmashed fragments and their positions; the grid indexes these.
+        std::vector<uint32_t> unsmashed_;
+        std::vector<float> unsmashed_x_, unsmashed_y_, unsmashed_z_;
         float multiplier_exponent = 20.0f;
     };
 }
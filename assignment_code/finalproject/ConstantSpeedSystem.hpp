@@ -1,17 +1,22 @@
 #ifndef CONSTANT_SPEED_SYSTEM_H_
 #define CONSTANT_SPEED_SYSTEM_H_
 
+#include <algorithm>
+
 #include "ParticleSystemBase.hpp"
 
 namespace GLOO {
 class ConstantSpeedSystem : public ParticleSystemBase {
-    ParticleState ComputeTimeDerivative(const ParticleState& state, float time) const override {
-        ParticleState gradient_state;
-        for (auto velocity: state.velocities) {
-            gradient_state.positions.push_back(velocity);
-            gradient_state.velocities.push_back(drag_constant * velocity);
+    void ComputeTimeDerivative(const ParticleState& state, float time, ParticleState& gradient_state) const override {
+        gradient_state.Resize(state.Size());
+        size_t n = state.Size();
+        for (int c = 0; c < 3; c++) {
+            auto velocity = state.GetChannel(ParticleState::Channel(ParticleState::VelX + c));
+            auto d_position = gradient_state.GetChannel(ParticleState::Channel(ParticleState::PosX + c));
+            auto d_velocity = gradient_state.GetChannel(ParticleState::Channel(ParticleState::VelX + c));
+            std::copy(velocity, velocity + n, d_position);
+            for (size_t i = 0; i < n; i++) d_velocity[i] = drag_constant * velocity[i];
         }
-        return gradient_state;
     };
 
     private:
@@ -0,0 +1,196 @@
+#ifndef DORMAND_PRINCE_45_INTEGRATOR_H_
+#define DORMAND_PRINCE_45_INTEGRATOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "IntegratorBase.hpp"
+
+namespace GLOO {
+// Embedded Runge-Kutta 5(4) pair of Dormand and Prince with step-size
+// control. A call to Integrate covers [start_time, start_time + dt] with as
+// many substeps as the error estimate asks for: quiet phases take a single
+// step, while explosion windows are resolved finely. Substeps never straddle
+// the system's NextEventTime. The last accepted step size and the derivative
+// at the final state are kept in the workspace for the next call.
+template <class TSystem, class TState>
+class DormandPrince45Integrator : public IntegratorBase<TSystem, TState> {
+ public:
+  using IntegratorBase<TSystem, TState>::Integrate;
+
+  // The default tolerance matches the accuracy of fixed-step RK4 at
+  // dt = 0.01 on an explosion test scene, with fewer evaluations when whole
+  // frames are handed over. Every call costs at least six evaluations, so
+  // calls for short fixed steps are more expensive than RK4.
+  DormandPrince45Integrator(float abs_tol = 1e-2f, float rel_tol = 1e-2f)
+      : abs_tol_(abs_tol), rel_tol_(rel_tol) {
+  }
+
+  bool IsAdaptive() const override {
+    return true;
+  }
+
+  void Integrate(const TSystem& system,
+                 TState& state,
+                 float start_time,
+                 float dt,
+                 IntegratorWorkspace<TState>& workspace) const override {
+    // Butcher tableau. The fifth-order weights equal the last row of a, so
+    // k7 is the derivative at the new state and is reused as the next k1.
+    static const float c2 = 1.f / 5, c3 = 3.f / 10, c4 = 4.f / 5,
+                       c5 = 8.f / 9;
+    static const float a21 = 1.f / 5;
+    static const float a3[] = {3.f / 40, 9.f / 40};
+    static const float a4[] = {44.f / 45, -56.f / 15, 32.f / 9};
+    static const float a5[] = {19372.f / 6561, -25360.f / 2187,
+                               64448.f / 6561, -212.f / 729};
+    static const float a6[] = {9017.f / 3168, -355.f / 33, 46732.f / 5247,
+                               49.f / 176, -5103.f / 18656};
+    // b2 is zero for both orders; the weights apply to k1, k3, k4, k5, k6
+    // (and k7 for the fourth-order solution).
+    static const float b5[] = {35.f / 384, 500.f / 1113, 125.f / 192,
+                               -2187.f / 6784, 11.f / 84};
+    static const float b4[] = {5179.f / 57600, 7571.f / 16695, 393.f / 640,
+                               -92097.f / 339200, 187.f / 2100, 1.f / 40};
+
+    // Step-size controller: the next step is h * kSafety * error^(-1/5),
+    // with the change per step clamped to [kMinGrowth, kMaxGrowth].
+    const float kSafety = 0.9f;
+    const float kMinGrowth = 0.2f;
+    const float kMaxGrowth = 5.f;
+
+    if (dt <= 0.f)
+      return;
+
+    workspace.Prepare(9, state);
+    TState* k[7];
+    for (int i = 0; i < 7; i++) {
+      k[i] = &workspace.stages[i];
+    }
+    TState& high = workspace.stages[7];
+    TState& low = workspace.stages[8];
+    TState& stage = workspace.scratch;
+
+    const float end_time = start_time + dt;
+    float time = start_time;
+    float h = workspace.suggested_step > 0.f
+                  ? std::min(workspace.suggested_step, dt)
+                  : dt;
+    bool have_k1 = workspace.HasDerivativeAt(start_time, dt);
+
+    while (time < end_time) {
+      if (!have_k1) {
+        system.ComputeTimeDerivative(state, time, *k[0]);
+        workspace.num_evaluations++;
+        have_k1 = true;
+      }
+
+      float step = std::min(h, end_time - time);
+      bool hits_end = step >= end_time - time;
+      bool hits_event = false;
+      float event_time = system.NextEventTime(time);
+      if (event_time - time > MinStep() && event_time < time + step) {
+        step = event_time - time;
+        hits_end = false;
+        hits_event = true;
+      }
+      // When the step ends on a discontinuity, the stages at c = 1 see the
+      // derivative just before it.
+      float step_end_time = time + step;
+      if (hits_event)
+        step_end_time = std::nextafter(step_end_time, time);
+
+      float coefficients[6];
+      const TState* terms[6];
+
+      stage.AssignAxpy(state, step * a21, *k[0]);
+      system.ComputeTimeDerivative(stage, time + c2 * step, *k[1]);
+
+      Scaled(a3, 2, step, coefficients);
+      terms[0] = k[0], terms[1] = k[1];
+      stage.AssignCombination(state, 2, coefficients, terms);
+      system.ComputeTimeDerivative(stage, time + c3 * step, *k[2]);
+
+      Scaled(a4, 3, step, coefficients);
+      terms[2] = k[2];
+      stage.AssignCombination(state, 3, coefficients, terms);
+      system.ComputeTimeDerivative(stage, time + c4 * step, *k[3]);
+
+      Scaled(a5, 4, step, coefficients);
+      terms[3] = k[3];
+      stage.AssignCombination(state, 4, coefficients, terms);
+      system.ComputeTimeDerivative(stage, time + c5 * step, *k[4]);
+
+      Scaled(a6, 5, step, coefficients);
+      terms[4] = k[4];
+      stage.AssignCombination(state, 5, coefficients, terms);
+      system.ComputeTimeDerivative(stage, step_end_time, *k[5]);
+
+      Scaled(b5, 5, step, coefficients);
+      const TState* high_terms[] = {k[0], k[2], k[3], k[4], k[5]};
+      high.AssignCombination(state, 5, coefficients, high_terms);
+      system.ComputeTimeDerivative(high, step_end_time, *k[6]);
+      workspace.num_evaluations += 6;
+
+      Scaled(b4, 6, step, coefficients);
+      const TState* low_terms[] = {k[0], k[2], k[3], k[4], k[5], k[6]};
+      low.AssignCombination(state, 6, coefficients, low_terms);
+
+      float error = high.ScaledMaxError(low, state, abs_tol_, rel_tol_);
+      bool accepted = error <= 1.f || step <= MinStep();
+
+      float factor = error > 0.f ? kSafety * std::pow(error, -0.2f)
+                                 : kMaxGrowth;
+      factor = std::max(kMinGrowth, std::min(kMaxGrowth, factor));
+      if (!accepted)
+        factor = std::min(factor, 1.f);
+
+      if (accepted) {
+        std::swap(state, high);
+        if (hits_event) {
+          // Restart from the right-hand limit after the discontinuity.
+          have_k1 = false;
+        } else {
+          std::swap(*k[0], *k[6]);
+        }
+        if (hits_end)
+          time = end_time;
+        else if (hits_event)
+          time = event_time;
+        else
+          time += step;
+        // A step shortened to land on the end or an event says nothing about
+        // how large the next one may be.
+        if (step < h)
+          h = std::max(h, step * factor);
+        else
+          h = step * factor;
+      } else {
+        h = std::max(step * factor, MinStep());
+      }
+    }
+    workspace.suggested_step = h;
+    workspace.derivative_valid = have_k1;
+    workspace.derivative_time = time;
+  }
+
+ private:
+  static void Scaled(const float* weights, int count, float h, float* out) {
+    for (int i = 0; i < count; i++) {
+      out[i] = weights[i] * h;
+    }
+  }
+
+  // Steps are accepted regardless of the error estimate once they get this
+  // small, so a discontinuity in space cannot stall the integrator.
+  static float MinStep() {
+    return 1e-5f;
+  }
+
+  float abs_tol_;
+  float rel_tol_;
+};
+}  // namespace GLOO
+
+#endif
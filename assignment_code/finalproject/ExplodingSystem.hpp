@@ -1,76 +1,189 @@
 #ifndef EXPLODING_SYSTEM_H_
 #define EXPLODING_SYSTEM_H_
 
-#include "ParticleSystemBase.hpp"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+#include "BombList.hpp"
+#include "FragmentSystemBase.hpp"
+#include "FragmentGeometry.hpp"
+#include "UniformGrid.hpp"
+#include "gloo/ThreadPool.hpp"
 
 namespace GLOO {
-class ExplodingSystem : public ParticleSystemBase {
+class ExplodingSystem : public FragmentSystemBase {
     public:
-    ExplodingSystem() {
-        num_explosive = 0;
-        start_explosion_.clear();
-        epsilon_.clear();
-        expansion_rate_.clear();
-        explosion_center_.clear();
-        explosion_coef_.clear();
-    }
-
     void ClearBomb() {
-        num_explosive = 0;
-        start_explosion_.clear();
-        epsilon_.clear();
-        expansion_rate_.clear();
-        explosion_center_.clear();
-        explosion_coef_.clear();
+        bombs_.Clear();
     }
 
     void AddBomb(float starting_time, glm::vec3 position, float multiplier) {
-        num_explosive ++;
-        start_explosion_.push_back(starting_time);
-        epsilon_.push_back(base_epsilon);
-        expansion_rate_.push_back(multiplier * base_expansion);
-        explosion_center_.push_back(position);
-        explosion_coef_.push_back((1.0f / multiplier) * base_coef);
+        bombs_.Add(starting_time, base_epsilon, multiplier * base_expansion, position, (1.0f / multiplier) * base_coef);
+    }
+
+    // Drops the bombs whose force window has closed by time, so that later
+    // derivative evaluations only look at live and upcoming bombs. time must
+    // not be later than the earliest time the system is evaluated at next.
+    void RetireExpired(float time) {
+        bombs_.RetireExpired(time);
+    }
+
+    // Fragment shapes are shared with the owner of the state, which uses them
+    // to reconstruct vertices for rendering and collision.
+    void SetGeometry(std::shared_ptr<const FragmentGeometry> geometry) {
+        geometry_ = std::move(geometry);
     }
+
     private:
-    ParticleState ComputeTimeDerivative(const ParticleState& state, float time) const override {
-        ParticleState gradient_state;
-        std::vector<bool> get_rekt_(num_explosive, false);
-        std::vector<float> time_since_explode_(num_explosive, 0.f);
-        for(int i=0; i<num_explosive; i++){
-            if(time >= start_explosion_[i] && time < start_explosion_[i] + epsilon_[i]){
-                get_rekt_[i] = true;
-                time_since_explode_[i] = time - start_explosion_[i];
+    void ComputeTimeDerivative(const FragmentState& state, float time, FragmentState& gradient_state) const override {
+        // Without the fragment shapes there is no inertia to rotate with.
+        if (geometry_ == nullptr || geometry_->Size() != state.Size()) {
+            throw std::runtime_error("ExplodingSystem has no geometry for this fragment state!");
+        }
+        gradient_state.Resize(state.Size());
+        // Bombs whose force window contains time; scratch storage is kept
+        // around so that evaluating the derivative does not allocate.
+        active_bombs_.clear();
+        time_since_explode_.clear();
+        // Bombs are sorted by start time, so only the ones that have started
+        // need checking.
+        size_t num_started = bombs_.NumStarted(time);
+        for(size_t i=0; i<num_started; i++){
+            if(time < bombs_.start[i] + bombs_.epsilon[i]){
+                active_bombs_.push_back(i);
+                time_since_explode_.push_back(time - bombs_.start[i]);
             }
         }
-        for (int i = 0; i < state.positions.size() / 3; i++) {
-            for(int j=0; j<3; j++) gradient_state.positions.push_back(state.velocities[3 * i]);
-            auto drag_force = -drag_constant * state.velocities[3 * i];
-            auto acceleration = gravity_ + drag_force;
-            for(int k=0; k<num_explosive; k++){
-                if(get_rekt_[k])
-                {
-                    glm::vec3 avg_explosion = glm::vec3(0.f,0.f,0.f);
-                    for(int j=0; j<3; j++){
-                        avg_explosion += ExplodingSystem::CalcExplosionAcc(state.positions[3 * i + j], k, time_since_explode_[k]);
-                    }
-                    acceleration += avg_explosion * (1.0f/3.0f) * (1.0f - time_since_explode_[k] / epsilon_[k]);
-                }
+        // Fragments are independent and each writes only its own entries of
+        // gradient_state, so they are split across the thread pool.
+        ThreadPool::GetInstance().ParallelFor(state.Size(), 1024, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                ComputeFragmentDerivative(state, i, gradient_state);
             }
+        });
+        if (active_bombs_.empty() || state.Size() == 0)
+            return;
 
-            for(int j=0; j<3; j++) gradient_state.velocities.push_back(acceleration);
+        // A bomb only pushes vertices inside its expansion sphere, so each one
+        // looks up just the fragments the grid finds near that sphere instead
+        // of visiting every fragment.
+        bomb_grid_.Build(state.GetChannel(FragmentState::PosX),
+                         state.GetChannel(FragmentState::PosY),
+                         state.GetChannel(FragmentState::PosZ),
+                         state.Size(),
+                         2.f * geometry_->max_radius);
+        pair_fragments_.clear();
+        pair_bombs_.clear();
+        for(size_t a=0; a<active_bombs_.size(); a++){
+            size_t k = active_bombs_[a];
+            float reach = time_since_explode_[a] * bombs_.expansion_rate[k] + geometry_->max_radius;
+            glm::vec3 center = bombs_.GetCenter(k);
+            bomb_candidates_.clear();
+            bomb_grid_.QueryUnordered(center - glm::vec3(reach), center + glm::vec3(reach), bomb_candidates_);
+            for (uint32_t i : bomb_candidates_) {
+                glm::vec3 offset = state.GetPosition(i) - center;
+                if (glm::dot(offset, offset) > reach * reach)
+                    continue;
+                pair_fragments_.push_back(i);
+                pair_bombs_.push_back(uint32_t(a));
+            }
         }
 
-        return gradient_state;
+        // Group the (fragment, bomb) pairs by fragment with a stable counting
+        // sort, so that each hit fragment is processed once with its bombs in
+        // order (the order of fragments within a bomb does not matter). The
+        // sum is then the same whatever the thread count.
+        fragment_pair_start_.assign(state.Size() + 1, 0);
+        for (uint32_t i : pair_fragments_) {
+            fragment_pair_start_[i + 1]++;
+        }
+        hit_fragments_.clear();
+        for (size_t i = 0; i < state.Size(); i++) {
+            if (fragment_pair_start_[i + 1] > 0)
+                hit_fragments_.push_back(uint32_t(i));
+            fragment_pair_start_[i + 1] += fragment_pair_start_[i];
+        }
+        pair_cursor_.assign(fragment_pair_start_.begin(), fragment_pair_start_.end() - 1);
+        fragment_pair_bombs_.resize(pair_bombs_.size());
+        for (size_t p = 0; p < pair_fragments_.size(); p++) {
+            fragment_pair_bombs_[pair_cursor_[pair_fragments_[p]]++] = pair_bombs_[p];
+        }
+
+        ThreadPool::GetInstance().ParallelFor(hit_fragments_.size(), 32, [&](size_t begin, size_t end) {
+            for (size_t h = begin; h < end; h++) {
+                AddBombDerivative(state, hit_fragments_[h], gradient_state);
+            }
+        });
     };
 
+    // Free motion of fragment i: gravity, drag and torque-free rotation.
+    void ComputeFragmentDerivative(const FragmentState& state, size_t i, FragmentState& gradient_state) const {
+        glm::vec3 velocity = state.GetVelocity(i);
+        glm::vec3 omega = state.GetAngularVelocity(i);
+        glm::quat orientation = state.GetOrientation(i);
+
+        gradient_state.SetPosition(i, velocity);
+        // dq/dt = 0.5 * (0, omega) * q
+        gradient_state.SetOrientation(i, 0.5f * (glm::quat(0.f, omega.x, omega.y, omega.z) * orientation));
+
+        auto drag_force = -drag_constant * velocity;
+        gradient_state.SetVelocity(i, gravity_ + drag_force);
+
+        // Euler's equations in the world frame, plus the same drag as on
+        // the linear velocity:
+        // dw/dt = I^-1 (torque - w x (I w)) - drag * w, with I = R I_body R^T.
+        // The torque term is added by AddBombDerivative.
+        glm::mat3 rotation = glm::mat3_cast(orientation);
+        glm::mat3 inertia = rotation * geometry_->inertia[i] * glm::transpose(rotation);
+        glm::mat3 inverse_inertia = rotation * geometry_->inverse_inertia[i] * glm::transpose(rotation);
+        gradient_state.SetAngularVelocity(i, -(inverse_inertia * glm::cross(omega, inertia * omega)) - drag_constant * omega);
+    }
+
+    // Adds the push of the active bombs that reach fragment i to its
+    // derivative.
+    void AddBombDerivative(const FragmentState& state, size_t i, FragmentState& gradient_state) const {
+        glm::vec3 vertices[3];
+        geometry_->GetVertices(state, i, vertices);
+        glm::vec3 center = state.GetPosition(i);
+        glm::vec3 acceleration(0.f, 0.f, 0.f);
+        glm::vec3 torque(0.f, 0.f, 0.f);
+        for(uint32_t p=fragment_pair_start_[i]; p<fragment_pair_start_[i + 1]; p++){
+            size_t a = fragment_pair_bombs_[p];
+            size_t k = active_bombs_[a];
+            float falloff = (1.0f/3.0f) * (1.0f - time_since_explode_[a] / bombs_.epsilon[k]);
+            // Each vertex carries a third of the mass and feels the blast at
+            // its own position, which also spins the fragment.
+            for(int j=0; j<3; j++){
+                glm::vec3 force = falloff * ExplodingSystem::CalcExplosionAcc(vertices[j], k, time_since_explode_[a]);
+                acceleration += force;
+                torque += glm::cross(vertices[j] - center, force);
+            }
+        }
+        glm::mat3 rotation = glm::mat3_cast(state.GetOrientation(i));
+        glm::mat3 inverse_inertia = rotation * geometry_->inverse_inertia[i] * glm::transpose(rotation);
+        gradient_state.SetVelocity(i, gradient_state.GetVelocity(i) + acceleration);
+        gradient_state.SetAngularVelocity(i, gradient_state.GetAngularVelocity(i) + inverse_inertia * torque);
+    }
+
     public:
-    glm::vec3 CalcExplosionAcc(glm::vec3 vertex_position, int k, float timer) const
+    // Bomb forces switch on at start and off epsilon later.
+    float NextEventTime(float time) const override {
+        float next = FragmentSystemBase::NextEventTime(time);
+        size_t num_started = bombs_.NumStarted(time);
+        for(size_t i=0; i<num_started; i++){
+            if(bombs_.start[i] + bombs_.epsilon[i] > time) next = std::min(next, bombs_.start[i] + bombs_.epsilon[i]);
+        }
+        if(num_started < bombs_.Size()) next = std::min(next, bombs_.start[num_started]);
+        return next;
+    }
+
+    glm::vec3 CalcExplosionAcc(glm::vec3 vertex_position, size_t k, float timer) const
     {
-        glm::vec3 direction = vertex_position - explosion_center_[k];
+        glm::vec3 direction = vertex_position - bombs_.GetCenter(k);
         float dist = glm::length(direction);
-        if(dist == 0.0f || dist > timer * expansion_rate_[k]) return glm::vec3(0.f,0.f,0.f);
-        float explosion_attenuation = explosion_coef_[k][0] * dist * dist + explosion_coef_[k][1] * dist + explosion_coef_[k][2];
+        if(dist == 0.0f || dist > timer * bombs_.expansion_rate[k]) return glm::vec3(0.f,0.f,0.f);
+        float explosion_attenuation = bombs_.coef_a[k] * dist * dist + bombs_.coef_b[k] * dist + bombs_.coef_c[k];
         return direction / (dist * explosion_attenuation);
     }
 
@@ -84,12 +197,24 @@ class ExplodingSystem : public ParticleSystemBase {
     // glm::vec3 explosion_coef = glm::vec3(1.0f, 0.0f, 0.2f);
 
     //using more than one explosive
-    int num_explosive = 2;
-    std::vector<float> start_explosion_ = {3.0f, 2.6f};
-    std::vector<float> epsilon_ = {0.5f, 0.8f};
-    std::vector<float> expansion_rate_ = {10.0f, 2.0f};
-    std::vector<glm::vec3> explosion_center_ = {glm::vec3(0.15f,0.067f,0.f), glm::vec3(-0.2f,0.067f,0.f)}; 
-    std::vector<glm::vec3> explosion_coef_ = {glm::vec3(0.9f, 0.0f, 0.1f),glm::vec3(1.1f, 0.0f, 0.3f)};
+    BombList bombs_;
+
+    std::shared_ptr<const FragmentGeometry> geometry_;
+
+    // scratch for ComputeTimeDerivative
+    mutable std::vector<size_t> active_bombs_;
+    mutable std::vector<float> time_since_explode_;
+    mutable UniformGrid bomb_grid_;
+    mutable std::vector<uint32_t> bomb_candidates_;
+    // (fragment, active bomb) pairs within reach, and the same bombs grouped
+    // by fragment: those of fragment i are fragment_pair_bombs_[p] for p in
+    // [fragment_pair_start_[i], fragment_pair_start_[i + 1]).
+    mutable std::vector<uint32_t> pair_fragments_;
+    mutable std::vector<uint32_t> pair_bombs_;
+    mutable std::vector<uint32_t> fragment_pair_start_;
+    mutable std::vector<uint32_t> fragment_pair_bombs_;
+    mutable std::vector<uint32_t> pair_cursor_;
+    mutable std::vector<uint32_t> hit_fragments_;
 
     //collision adjustment
     float base_expansion = 4.0f;
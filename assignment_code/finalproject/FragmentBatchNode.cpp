@@ -0,0 +1,87 @@
+#include "FragmentBatchNode.hpp"
+#include "gloo/components/RenderingComponent.hpp"
+#include "gloo/components/ShadingComponent.hpp"
+#include "gloo/components/MaterialComponent.hpp"
+#include "gloo/ThreadPool.hpp"
+
+namespace GLOO {
+    FragmentBatchNode::FragmentBatchNode(std::shared_ptr<ShaderProgram> shader,
+                                         std::shared_ptr<Material> material,
+                                         std::shared_ptr<const FragmentGeometry> geometry,
+                                         const FragmentState& state,
+                                         const NormalArray& initial_normals)
+        : geometry_(std::move(geometry)), initial_normals_(initial_normals) {
+        if (initial_normals_.size() != 3 * state.Size()) {
+            throw std::runtime_error("FragmentBatchNode needs three normals per fragment!");
+        }
+        visible_.assign(state.Size(), true);
+        // Positions and normals are rewritten every frame.
+        batch_mesh_ = std::make_shared<VertexObject>(BufferUsage::Stream);
+        SetFragments(state);
+
+        CreateComponent<ShadingComponent>(std::move(shader));
+        CreateComponent<MaterialComponent>(std::move(material));
+        CreateComponent<RenderingComponent>(batch_mesh_).SetDrawMode(DrawMode::Triangles);
+    }
+
+    void FragmentBatchNode::SetFragments(const FragmentState& state) {
+        // Vertices are only reconstructed from the rigid state here; normals
+        // turn with the fragment. Every fragment writes its own three slots.
+        // The arrays keep their capacity from frame to frame and are uploaded
+        // straight from here, so the mesh holds no CPU copy.
+        positions_.resize(3 * state.Size());
+        normals_.resize(3 * state.Size());
+        ThreadPool::GetInstance().ParallelFor(state.Size(), 1024, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                geometry_->GetVertices(state, i, &positions_[3 * i]);
+                glm::quat orientation = state.GetOrientation(i);
+                for (int j = 0; j < 3; j++) {
+                    normals_[3 * i + j] = orientation * initial_normals_[3 * i + j];
+                }
+            }
+        });
+        // Every vertex lies within max_radius of its fragment's center, so
+        // the centers of the visible fragments give the bounds of what is
+        // drawn without going over the vertices again. The renderer culls
+        // the batch as a whole with them.
+        BoundingBox bounds;
+        for (size_t i = 0; i < state.Size(); i++) {
+            if (visible_[i]) bounds.Extend(state.GetPosition(i));
+        }
+        if (!bounds.IsEmpty()) {
+            bounds.min -= glm::vec3(geometry_->max_radius);
+            bounds.max += glm::vec3(geometry_->max_radius);
+        }
+        batch_mesh_->UploadPositions(positions_.data(), positions_.size(), bounds);
+        batch_mesh_->UploadNormals(normals_.data(), normals_.size());
+        if (indices_dirty_) {
+            UpdateIndices();
+        }
+    }
+
+    void FragmentBatchNode::SetFragmentVisible(size_t i, bool visible) {
+        if (visible_.at(i) != visible) {
+            visible_[i] = visible;
+            indices_dirty_ = true;
+        }
+    }
+
+    void FragmentBatchNode::SetAllFragmentsVisible(bool visible) {
+        visible_.assign(visible_.size(), visible);
+        indices_dirty_ = true;
+    }
+
+    void FragmentBatchNode::UpdateIndices() {
+        // Hidden fragments are compacted out of the index buffer, so the
+        // draw call only covers visible ones.
+        indices_.clear();
+        for (size_t i = 0; i < visible_.size(); i++) {
+            if (!visible_[i]) continue;
+            indices_.push_back(unsigned(3 * i));
+            indices_.push_back(unsigned(3 * i + 1));
+            indices_.push_back(unsigned(3 * i + 2));
+        }
+        batch_mesh_->UploadIndices(indices_.data(), indices_.size());
+        indices_dirty_ = false;
+    }
+}
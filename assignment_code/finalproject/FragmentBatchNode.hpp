@@ -0,0 +1,50 @@
+#ifndef FRAGMENT_BATCH_NODE_H_
+#define FRAGMENT_BATCH_NODE_H_
+
+#include "gloo/SceneNode.hpp"
+#include "FragmentState.hpp"
+#include "FragmentGeometry.hpp"
+#include "gloo/shaders/ShaderProgram.hpp"
+#include "gloo/Material.hpp"
+#include "gloo/VertexObject.hpp"
+
+namespace GLOO {
+    // Draws every fragment of a FragmentState with a single mesh: vertex
+    // 3 * i + j is corner j of fragment i, and the index buffer lists only
+    // the visible fragments, so the whole set takes one draw call per pass.
+    class FragmentBatchNode : public SceneNode {
+        public:
+        // initial_normals holds three normals per fragment in its local frame,
+        // i.e. as they were when the fragments were created.
+        FragmentBatchNode(std::shared_ptr<ShaderProgram> shader,
+                          std::shared_ptr<Material> material,
+                          std::shared_ptr<const FragmentGeometry> geometry,
+                          const FragmentState& state,
+                          const NormalArray& initial_normals);
+
+        // Rebuilds the vertices of all fragments from state and uploads them,
+        // along with the indices if the visible set changed.
+        void SetFragments(const FragmentState& state);
+
+        // All fragments start visible. Changes take effect at the next
+        // SetFragments.
+        void SetFragmentVisible(size_t i, bool visible);
+        void SetAllFragmentsVisible(bool visible);
+
+        private:
+        void UpdateIndices();
+
+        std::shared_ptr<const FragmentGeometry> geometry_;
+        NormalArray initial_normals_;
+        std::shared_ptr<VertexObject> batch_mesh_;
+        // staging for the uploads
+        PositionArray positions_;
+        NormalArray normals_;
+        IndexArray indices_;
+
+        std::vector<bool> visible_;
+        bool indices_dirty_ = true;
+    };
+}
+
+#endif
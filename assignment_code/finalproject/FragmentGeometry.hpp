@@ -0,0 +1,82 @@
+#ifndef FRAGMENT_GEOMETRY_H_
+#define FRAGMENT_GEOMETRY_H_
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "FragmentState.hpp"
+
+namespace GLOO {
+// Constant shape data of triangular fragments: the offsets of the three
+// vertices from the center of mass in the fragment's local frame, and the
+// inertia of three equal point masses (total mass 1) at those vertices. The
+// local frame is the world frame at the time the fragments are created, so
+// fragments start out with identity orientation.
+struct FragmentGeometry {
+  std::vector<glm::vec3> local_offsets;
+  std::vector<glm::mat3> inertia;
+  std::vector<glm::mat3> inverse_inertia;
+  // Largest vertex distance from the center, for conservative bounds.
+  float max_radius = 0.f;
+
+  size_t Size() const {
+    return inertia.size();
+  }
+
+  // Builds the geometry for consecutive vertex triples and writes the
+  // matching initial state (at rest, identity orientation) into state.
+  static FragmentGeometry FromTriangles(const std::vector<glm::vec3>& vertices,
+                                        FragmentState& state) {
+    if (vertices.size() % 3 != 0) {
+      throw std::runtime_error("Fragment vertices must come in triples!");
+    }
+    FragmentGeometry geometry;
+    size_t num_fragments = vertices.size() / 3;
+    geometry.local_offsets.resize(vertices.size());
+    geometry.inertia.resize(num_fragments);
+    geometry.inverse_inertia.resize(num_fragments);
+    state.Resize(num_fragments);
+    for (size_t i = 0; i < num_fragments; i++) {
+      glm::vec3 center =
+          (vertices[3 * i] + vertices[3 * i + 1] + vertices[3 * i + 2]) / 3.f;
+      glm::mat3 inertia(0.f);
+      for (size_t j = 3 * i; j < 3 * i + 3; j++) {
+        glm::vec3 r = vertices[j] - center;
+        geometry.local_offsets[j] = r;
+        geometry.max_radius = std::max(geometry.max_radius, glm::length(r));
+        inertia += (glm::dot(r, r) * glm::mat3(1.f) - glm::outerProduct(r, r)) /
+                   3.f;
+      }
+      // Degenerate (collinear) triangles have no inertia about their own
+      // axis; a small isotropic term keeps the tensor invertible.
+      float trace = inertia[0][0] + inertia[1][1] + inertia[2][2];
+      inertia += glm::mat3(1e-4f * trace + 1e-12f);
+      geometry.inertia[i] = inertia;
+      geometry.inverse_inertia[i] = glm::inverse(inertia);
+
+      state.SetPosition(i, center);
+      state.SetOrientation(i, glm::quat(1.f, 0.f, 0.f, 0.f));
+      state.SetVelocity(i, glm::vec3(0.f));
+      state.SetAngularVelocity(i, glm::vec3(0.f));
+    }
+    return geometry;
+  }
+
+  // World-space positions of the vertices of fragment i.
+  void GetVertices(const FragmentState& state,
+                   size_t i,
+                   glm::vec3 vertices[3]) const {
+    glm::vec3 center = state.GetPosition(i);
+    glm::quat orientation = state.GetOrientation(i);
+    for (size_t j = 0; j < 3; j++) {
+      vertices[j] = center + orientation * local_offsets[3 * i + j];
+    }
+  }
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef FRAGMENT_STATE_H_
+#define FRAGMENT_STATE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "ParticleKernels.hpp"
+
+namespace GLOO {
+struct FragmentState {
+  // The state of a set of rigid fragments: center of mass, orientation,
+  // velocity and world-frame angular velocity per fragment. Laid out like
+  // ParticleState, one aligned SoA buffer with every channel padded to a
+  // multiple of kSimdWidth. The position-like channels come first and the
+  // velocity-like ones last, so Kick touches one contiguous block. That is
+  // 13 floats per fragment, against 18 for three vertex positions and
+  // velocities, about 1.4x less.
+  enum Channel {
+    PosX = 0,
+    PosY,
+    PosZ,
+    RotW,
+    RotX,
+    RotY,
+    RotZ,
+    VelX,
+    VelY,
+    VelZ,
+    AngX,
+    AngY,
+    AngZ,
+    NumChannels
+  };
+
+  FragmentState() : size_(0), stride_(0) {
+  }
+
+  explicit FragmentState(size_t size) : size_(0), stride_(0) {
+    Resize(size);
+  }
+
+  // Contents are reset to fragments at the origin with identity orientation
+  // whenever the size changes; resizing to the current size is a no-op.
+  void Resize(size_t size) {
+    if (size == size_ && !data_.empty())
+      return;
+    size_ = size;
+    stride_ = PadToSimdWidth(size);
+    data_.assign(NumChannels * stride_, 0.f);
+    std::fill(GetChannel(RotW), GetChannel(RotW) + size_, 1.f);
+  }
+
+  size_t Size() const {
+    return size_;
+  }
+
+  float* GetChannel(Channel channel) {
+    return data_.data() + channel * stride_;
+  }
+  const float* GetChannel(Channel channel) const {
+    return data_.data() + channel * stride_;
+  }
+
+  glm::vec3 GetPosition(size_t i) const {
+    return Get3(PosX, i);
+  }
+  void SetPosition(size_t i, const glm::vec3& position) {
+    Set3(PosX, i, position);
+  }
+
+  glm::quat GetOrientation(size_t i) const {
+    return glm::quat(GetChannel(RotW)[i], GetChannel(RotX)[i],
+                     GetChannel(RotY)[i], GetChannel(RotZ)[i]);
+  }
+  void SetOrientation(size_t i, const glm::quat& orientation) {
+    GetChannel(RotW)[i] = orientation.w;
+    GetChannel(RotX)[i] = orientation.x;
+    GetChannel(RotY)[i] = orientation.y;
+    GetChannel(RotZ)[i] = orientation.z;
+  }
+
+  glm::vec3 GetVelocity(size_t i) const {
+    return Get3(VelX, i);
+  }
+  void SetVelocity(size_t i, const glm::vec3& velocity) {
+    Set3(VelX, i, velocity);
+  }
+
+  glm::vec3 GetAngularVelocity(size_t i) const {
+    return Get3(AngX, i);
+  }
+  void SetAngularVelocity(size_t i, const glm::vec3& angular_velocity) {
+    Set3(AngX, i, angular_velocity);
+  }
+
+  // Linear integrators only keep orientations approximately unit length;
+  // call this after each step.
+  void NormalizeOrientations() {
+    float* w = GetChannel(RotW);
+    float* x = GetChannel(RotX);
+    float* y = GetChannel(RotY);
+    float* z = GetChannel(RotZ);
+    for (size_t i = 0; i < size_; i++) {
+      float inv_length =
+          1.f / std::sqrt(w[i] * w[i] + x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+      w[i] *= inv_length;
+      x[i] *= inv_length;
+      y[i] *= inv_length;
+      z[i] *= inv_length;
+    }
+  }
+
+  // this = base + sum_j coefficients[j] * terms[j], fused into a single pass.
+  // base may be *this.
+  void AssignCombination(const FragmentState& base,
+                         size_t count,
+                         const float* coefficients,
+                         const FragmentState* const* terms) {
+    const size_t kMaxTerms = 8;
+    if (count > kMaxTerms) {
+      throw std::runtime_error("Too many terms in fragment state combination!");
+    }
+    const float* term_data[kMaxTerms];
+    for (size_t j = 0; j < count; j++) {
+      if (terms[j]->size_ != base.size_) {
+        throw std::runtime_error(
+            "Cannot combine fragment states with inconsistent sizes!");
+      }
+      term_data[j] = terms[j]->data_.data();
+    }
+    Resize(base.size_);
+    ParallelKernelCombine(data_.data(), base.data_.data(), count,
+                          coefficients, term_data, data_.size());
+  }
+
+  // this = base + a * term.
+  void AssignAxpy(const FragmentState& base,
+                  float a,
+                  const FragmentState& term) {
+    const FragmentState* terms[] = {&term};
+    AssignCombination(base, 1, &a, terms);
+  }
+
+  // Velocity half of a split step: v += dt * a and w += dt * alpha, taken
+  // from the velocity channels of derivative.
+  void Kick(const FragmentState& derivative, float dt) {
+    if (size_ != derivative.size_) {
+      throw std::runtime_error(
+          "Cannot kick a fragment state with an inconsistent derivative!");
+    }
+    KernelAxpy(GetChannel(VelX), dt, derivative.GetChannel(VelX),
+               6 * stride_);
+  }
+
+  // Position half of a split step: x += dt * v, and each orientation is
+  // rotated by its angular velocity over dt exactly.
+  void Drift(float dt) {
+    KernelAxpy(GetChannel(PosX), dt, GetChannel(VelX), 3 * stride_);
+    for (size_t i = 0; i < size_; i++) {
+      glm::vec3 omega = GetAngularVelocity(i);
+      float speed = glm::length(omega);
+      if (speed == 0.f)
+        continue;
+      float half_angle = 0.5f * speed * dt;
+      glm::vec3 axis = omega / speed;
+      glm::quat rotation(std::cos(half_angle), axis.x * std::sin(half_angle),
+                         axis.y * std::sin(half_angle),
+                         axis.z * std::sin(half_angle));
+      SetOrientation(i, rotation * GetOrientation(i));
+    }
+  }
+
+  // See ParticleState::ScaledMaxError.
+  float ScaledMaxError(const FragmentState& other,
+                       const FragmentState& reference,
+                       float abs_tol,
+                       float rel_tol) const {
+    if (size_ != other.size_ || size_ != reference.size_) {
+      throw std::runtime_error(
+          "Cannot compare fragment states with inconsistent sizes!");
+    }
+    return KernelScaledMaxError(data_.data(), other.data_.data(),
+                                reference.data_.data(), abs_tol, rel_tol,
+                                data_.size());
+  }
+
+ private:
+  glm::vec3 Get3(Channel first, size_t i) const {
+    return glm::vec3(GetChannel(first)[i], GetChannel(Channel(first + 1))[i],
+                     GetChannel(Channel(first + 2))[i]);
+  }
+  void Set3(Channel first, size_t i, const glm::vec3& value) {
+    GetChannel(first)[i] = value.x;
+    GetChannel(Channel(first + 1))[i] = value.y;
+    GetChannel(Channel(first + 2))[i] = value.z;
+  }
+
+  size_t size_;
+  size_t stride_;
+  AlignedFloatArray data_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef FRAGMENT_SYSTEM_BASE_H_
+#define FRAGMENT_SYSTEM_BASE_H_
+
+#include <limits>
+
+#include "FragmentState.hpp"
+
+namespace GLOO {
+// Counterpart of ParticleSystemBase for rigid fragments.
+class FragmentSystemBase {
+ public:
+  virtual ~FragmentSystemBase() {
+  }
+
+  // Writes the derivative of state into derivative, resizing it if needed.
+  // Implementations must not allocate once derivative has the right size.
+  virtual void ComputeTimeDerivative(const FragmentState& state,
+                                     float time,
+                                     FragmentState& derivative) const = 0;
+
+  FragmentState ComputeTimeDerivative(const FragmentState& state,
+                                      float time) const {
+    FragmentState derivative;
+    ComputeTimeDerivative(state, time, derivative);
+    return derivative;
+  }
+
+  // See ParticleSystemBase::NextEventTime.
+  virtual float NextEventTime(float time) const {
+    return std::numeric_limits<float>::infinity();
+  }
+};
+}  // namespace GLOO
+
+#endif
@@ -1,19 +1,76 @@
 #ifndef INTEGRATOR_BASE_H_
 #define INTEGRATOR_BASE_H_
 
+#include <cmath>
+#include <vector>
+
 #include "ParticleSystemBase.hpp"
 
 namespace GLOO {
+// Scratch states reused across steps so that stepping a state of unchanged
+// size does not allocate. Keep one per simulated state.
+template <class TState>
+struct IntegratorWorkspace {
+  std::vector<TState> stages;
+  TState scratch;
+  // Step-size estimate carried across calls by adaptive integrators, and a
+  // running count of derivative evaluations for diagnostics.
+  float suggested_step = 0.f;
+  size_t num_evaluations = 0;
+  // Integrators that end a step by evaluating the derivative at the new
+  // state leave it in stages[0] for the next step to reuse. Call
+  // Invalidate() after changing the state or the system between steps.
+  bool derivative_valid = false;
+  float derivative_time = 0.f;
+
+  void Invalidate() {
+    derivative_valid = false;
+  }
+
+  // Callers accumulate time in floats, so the cached derivative is matched
+  // to within a small fraction of the step rather than exactly.
+  bool HasDerivativeAt(float time, float dt) const {
+    return derivative_valid && std::fabs(derivative_time - time) <= 1e-3f * dt;
+  }
+
+  void Prepare(size_t num_stages, const TState& state) {
+    if (stages.size() < num_stages)
+      stages.resize(num_stages);
+    for (size_t i = 0; i < num_stages; i++) {
+      stages[i].Resize(state.Size());
+    }
+    scratch.Resize(state.Size());
+  }
+};
+
 template <class TSystem, class TState>
 class IntegratorBase {
  public:
   virtual ~IntegratorBase() {
   }
 
-  virtual TState Integrate(const TSystem& system,
-                           const TState& state,
-                           float start_time,
-                           float dt) const = 0;
+  // Adaptive integrators choose their own substeps inside Integrate, so
+  // callers may hand them a whole frame at once.
+  virtual bool IsAdaptive() const {
+    return false;
+  }
+
+  // Advances state from start_time to start_time + dt in place.
+  virtual void Integrate(const TSystem& system,
+                         TState& state,
+                         float start_time,
+                         float dt,
+                         IntegratorWorkspace<TState>& workspace) const = 0;
+
+  TState Integrate(const TSystem& system,
+                   const TState& state,
+                   float start_time,
+                   float dt) const {
+    TState next_state = state;
+    IntegratorWorkspace<TState> workspace;
+    Integrate(system, next_state, start_time, dt, workspace);
+    return next_state;
+  }
 };
 }  // namespace GLOO
 
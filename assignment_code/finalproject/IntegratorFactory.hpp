@@ -7,13 +7,34 @@
 
 #include "gloo/utils.hpp"
 #include "RungeKutta4Integrator.hpp"
+#include "DormandPrince45Integrator.hpp"
+#include "SymplecticEulerIntegrator.hpp"
+#include "VelocityVerletIntegrator.hpp"
 
 namespace GLOO {
+enum class IntegratorType {
+  RK4,
+  DormandPrince45,
+  SymplecticEuler,
+  VelocityVerlet
+};
+
 class IntegratorFactory {
  public:
   template <class TSystem, class TState>
-  static std::unique_ptr<IntegratorBase<TSystem, TState>> CreateIntegrator() {
-    return make_unique<RungeKutta4Integrator<TSystem, TState>>();
+  static std::unique_ptr<IntegratorBase<TSystem, TState>> CreateIntegrator(
+      IntegratorType type = IntegratorType::RK4) {
+    switch (type) {
+      case IntegratorType::RK4:
+        return make_unique<RungeKutta4Integrator<TSystem, TState>>();
+      case IntegratorType::DormandPrince45:
+        return make_unique<DormandPrince45Integrator<TSystem, TState>>();
+      case IntegratorType::SymplecticEuler:
+        return make_unique<SymplecticEulerIntegrator<TSystem, TState>>();
+      case IntegratorType::VelocityVerlet:
+        return make_unique<VelocityVerletIntegrator<TSystem, TState>>();
+    }
+    throw std::runtime_error("Unrecognized integrator type!");
   }
 };
 }  // namespace GLOO
@@ -0,0 +1,225 @@
+#ifndef PARTICLE_KERNELS_H_
+#define PARTICLE_KERNELS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "gloo/ThreadPool.hpp"
+
+// Pick the widest instruction set the compiler was told it may use. SSE2 is
+// part of the x86-64 baseline; AVX has to be requested (see ENABLE_AVX in
+// CMakeLists.txt). Anything else (e.g. arm64) uses the scalar fallback.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GLOO_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GLOO_SIMD_SSE
+#endif
+
+namespace GLOO {
+// Every SoA channel is padded to a multiple of kSimdWidth floats and starts on
+// a kSimdAlignment boundary, so the kernels below never need a scalar tail.
+const size_t kSimdWidth = 8;
+const size_t kSimdAlignment = 32;
+
+inline size_t PadToSimdWidth(size_t n) {
+  return (n + kSimdWidth - 1) / kSimdWidth * kSimdWidth;
+}
+
+// Memory comes from the global operator new, so that a replaced one (such
+// as the counting one in tests/IntegratorAllocationTest.cpp) sees it too.
+// Blocks are over-allocated and the start of each is stored just before
+// the aligned pointer.
+template <class T, size_t Alignment>
+class AlignedAllocator {
+ public:
+  using value_type = T;
+
+  template <class U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() {
+  }
+  template <class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) {
+  }
+
+  T* allocate(size_t n) {
+    const size_t kOverhead = Alignment - 1 + sizeof(void*);
+    if (n > (SIZE_MAX - kOverhead) / sizeof(T))
+      throw std::bad_alloc();
+    char* block =
+        static_cast<char*>(::operator new(n * sizeof(T) + kOverhead));
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(block) + kOverhead) &
+                        ~uintptr_t(Alignment - 1);
+    reinterpret_cast<void**>(aligned)[-1] = block;
+    return reinterpret_cast<T*>(aligned);
+  }
+
+  void deallocate(T* ptr, size_t) {
+    if (ptr != nullptr)
+      ::operator delete(reinterpret_cast<void**>(ptr)[-1]);
+  }
+};
+
+template <class T, class U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) {
+  return true;
+}
+
+template <class T, class U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) {
+  return false;
+}
+
+using AlignedFloatArray =
+    std::vector<float, AlignedAllocator<float, kSimdAlignment>>;
+
+// y += a * x over n floats. y and x must be kSimdAlignment-aligned.
+inline void KernelAxpy(float* y, float a, const float* x, size_t n) {
+  size_t i = 0;
+#if defined(GLOO_SIMD_AVX)
+  __m256 va = _mm256_set1_ps(a);
+  for (; i + 8 <= n; i += 8) {
+    __m256 vy = _mm256_load_ps(y + i);
+    __m256 vx = _mm256_load_ps(x + i);
+    _mm256_store_ps(y + i, _mm256_add_ps(vy, _mm256_mul_ps(va, vx)));
+  }
+#elif defined(GLOO_SIMD_SSE)
+  __m128 va = _mm_set1_ps(a);
+  for (; i + 4 <= n; i += 4) {
+    __m128 vy = _mm_load_ps(y + i);
+    __m128 vx = _mm_load_ps(x + i);
+    _mm_store_ps(y + i, _mm_add_ps(vy, _mm_mul_ps(va, vx)));
+  }
+#endif
+  for (; i < n; i++) {
+    y[i] += a * x[i];
+  }
+}
+
+// y += x over n floats.
+inline void KernelAdd(float* y, const float* x, size_t n) {
+  size_t i = 0;
+#if defined(GLOO_SIMD_AVX)
+  for (; i + 8 <= n; i += 8) {
+    _mm256_store_ps(y + i,
+                    _mm256_add_ps(_mm256_load_ps(y + i), _mm256_load_ps(x + i)));
+  }
+#elif defined(GLOO_SIMD_SSE)
+  for (; i + 4 <= n; i += 4) {
+    _mm_store_ps(y + i, _mm_add_ps(_mm_load_ps(y + i), _mm_load_ps(x + i)));
+  }
+#endif
+  for (; i < n; i++) {
+    y[i] += x[i];
+  }
+}
+
+// y *= a over n floats.
+inline void KernelScale(float* y, float a, size_t n) {
+  size_t i = 0;
+#if defined(GLOO_SIMD_AVX)
+  __m256 va = _mm256_set1_ps(a);
+  for (; i + 8 <= n; i += 8) {
+    _mm256_store_ps(y + i, _mm256_mul_ps(va, _mm256_load_ps(y + i)));
+  }
+#elif defined(GLOO_SIMD_SSE)
+  __m128 va = _mm_set1_ps(a);
+  for (; i + 4 <= n; i += 4) {
+    _mm_store_ps(y + i, _mm_mul_ps(va, _mm_load_ps(y + i)));
+  }
+#endif
+  for (; i < n; i++) {
+    y[i] *= a;
+  }
+}
+
+// out = base + sum_j coefficients[j] * terms[j] over n floats, in one pass.
+// out may alias base, which turns this into an in-place accumulation.
+inline void KernelCombine(float* out,
+                          const float* base,
+                          size_t count,
+                          const float* coefficients,
+                          const float* const* terms,
+                          size_t n) {
+  size_t i = 0;
+#if defined(GLOO_SIMD_AVX)
+  for (; i + 8 <= n; i += 8) {
+    __m256 acc = _mm256_load_ps(base + i);
+    for (size_t j = 0; j < count; j++) {
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(coefficients[j]),
+                                             _mm256_load_ps(terms[j] + i)));
+    }
+    _mm256_store_ps(out + i, acc);
+  }
+#elif defined(GLOO_SIMD_SSE)
+  for (; i + 4 <= n; i += 4) {
+    __m128 acc = _mm_load_ps(base + i);
+    for (size_t j = 0; j < count; j++) {
+      acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(coefficients[j]),
+                                       _mm_load_ps(terms[j] + i)));
+    }
+    _mm_store_ps(out + i, acc);
+  }
+#endif
+  for (; i < n; i++) {
+    float acc = base[i];
+    for (size_t j = 0; j < count; j++) {
+      acc += coefficients[j] * terms[j][i];
+    }
+    out[i] = acc;
+  }
+}
+
+// KernelCombine spread over the thread pool. Chunks are whole SIMD blocks,
+// so every chunk stays aligned, and since the kernel is element-wise the
+// result does not depend on the thread count. Small states run inline.
+inline void ParallelKernelCombine(float* out,
+                                  const float* base,
+                                  size_t count,
+                                  const float* coefficients,
+                                  const float* const* terms,
+                                  size_t n) {
+  const size_t kMaxTerms = 8;
+  const size_t kGrain = 16 * 1024;
+  ThreadPool::GetInstance().ParallelFor(
+      n, kGrain, [=](size_t begin, size_t end) {
+        const float* chunk_terms[kMaxTerms];
+        for (size_t j = 0; j < count && j < kMaxTerms; j++) {
+          chunk_terms[j] = terms[j] + begin;
+        }
+        KernelCombine(out + begin, base + begin, count, coefficients,
+                      chunk_terms, end - begin);
+      });
+}
+
+// max_i |a[i] - b[i]| / (abs_tol + rel_tol * max(|a[i]|, |reference[i]|)),
+// the error measure used for adaptive step-size control.
+inline float KernelScaledMaxError(const float* a,
+                                  const float* b,
+                                  const float* reference,
+                                  float abs_tol,
+                                  float rel_tol,
+                                  size_t n) {
+  float error = 0.f;
+  for (size_t i = 0; i < n; i++) {
+    float scale =
+        abs_tol + rel_tol * std::max(std::fabs(a[i]), std::fabs(reference[i]));
+    error = std::max(error, std::fabs(a[i] - b[i]) / scale);
+  }
+  return error;
+}
+}  // namespace GLOO
+
+#endif
@@ -1,39 +1,194 @@
 #ifndef PARTICLE_STATE_H_
 #define PARTICLE_STATE_H_
 
+#include <cstddef>
 #include <vector>
 #include <stdexcept>
 
 #include <glm/glm.hpp>
 
+#include "ParticleKernels.hpp"
+
 namespace GLOO {
 struct ParticleState {
-  // The state of a particle system: positions and velocities.
-  std::vector<glm::vec3> positions;
-  std::vector<glm::vec3> velocities;
+  // The state of a particle system: positions and velocities, stored as
+  // structure-of-arrays. All six channels live in one aligned buffer, each
+  // padded to a multiple of kSimdWidth, so whole-state arithmetic is a single
+  // SIMD loop over the buffer.
+  enum Channel { PosX = 0, PosY, PosZ, VelX, VelY, VelZ, NumChannels };
 
-  ParticleState& operator+=(const ParticleState& rhs) {
-    if (positions.size() != rhs.positions.size() ||
-        velocities.size() != rhs.velocities.size() ||
-        positions.size() != rhs.velocities.size()) {
+  ParticleState() : size_(0), stride_(0) {
+  }
+
+  explicit ParticleState(size_t size) : size_(0), stride_(0) {
+    Resize(size);
+  }
+
+  // Contents are zeroed whenever the size changes. Resizing to the current
+  // size is a no-op, so preallocated states can be reused without touching
+  // the heap.
+  void Resize(size_t size) {
+    if (size == size_ && !data_.empty())
+      return;
+    size_ = size;
+    stride_ = PadToSimdWidth(size);
+    data_.assign(NumChannels * stride_, 0.f);
+  }
+
+  size_t Size() const {
+    return size_;
+  }
+
+  float* GetChannel(Channel channel) {
+    return data_.data() + channel * stride_;
+  }
+  const float* GetChannel(Channel channel) const {
+    return data_.data() + channel * stride_;
+  }
+
+  glm::vec3 GetPosition(size_t i) const {
+    return glm::vec3(GetChannel(PosX)[i], GetChannel(PosY)[i],
+                     GetChannel(PosZ)[i]);
+  }
+  void SetPosition(size_t i, const glm::vec3& position) {
+    GetChannel(PosX)[i] = position.x;
+    GetChannel(PosY)[i] = position.y;
+    GetChannel(PosZ)[i] = position.z;
+  }
+
+  glm::vec3 GetVelocity(size_t i) const {
+    return glm::vec3(GetChannel(VelX)[i], GetChannel(VelY)[i],
+                     GetChannel(VelZ)[i]);
+  }
+  void SetVelocity(size_t i, const glm::vec3& velocity) {
+    GetChannel(VelX)[i] = velocity.x;
+    GetChannel(VelY)[i] = velocity.y;
+    GetChannel(VelZ)[i] = velocity.z;
+  }
+
+  // Conversion shim for code that still thinks in arrays of glm::vec3.
+  static ParticleState FromArrays(const std::vector<glm::vec3>& positions,
+                                  const std::vector<glm::vec3>& velocities) {
+    if (positions.size() != velocities.size()) {
       throw std::runtime_error(
-          "Cannot add particle states with inconsistent sizes!");
+          "Cannot build a particle state with inconsistent sizes!");
     }
-
+    ParticleState state(positions.size());
     for (size_t i = 0; i < positions.size(); i++) {
-      positions[i] += rhs.positions[i];
-      velocities[i] += rhs.velocities[i];
+      state.SetPosition(i, positions[i]);
+      state.SetVelocity(i, velocities[i]);
+    }
+    return state;
+  }
+
+  std::vector<glm::vec3> GetPositions() const {
+    std::vector<glm::vec3> positions(size_);
+    for (size_t i = 0; i < size_; i++) {
+      positions[i] = GetPosition(i);
+    }
+    return positions;
+  }
+
+  std::vector<glm::vec3> GetVelocities() const {
+    std::vector<glm::vec3> velocities(size_);
+    for (size_t i = 0; i < size_; i++) {
+      velocities[i] = GetVelocity(i);
+    }
+    return velocities;
+  }
+
+  ParticleState& operator+=(const ParticleState& rhs) {
+    if (size_ != rhs.size_) {
+      throw std::runtime_error(
+          "Cannot add particle states with inconsistent sizes!");
     }
+    KernelAdd(data_.data(), rhs.data_.data(), data_.size());
     return *this;
   }
 
   ParticleState& operator*=(float k) {
-    for (size_t i = 0; i < positions.size(); i++) {
-      positions[i] *= k;
-      velocities[i] *= k;
+    KernelScale(data_.data(), k, data_.size());
+    return *this;
+  }
+
+  // this += a * rhs, in one pass.
+  ParticleState& Axpy(float a, const ParticleState& rhs) {
+    if (size_ != rhs.size_) {
+      throw std::runtime_error(
+          "Cannot add particle states with inconsistent sizes!");
     }
+    KernelAxpy(data_.data(), a, rhs.data_.data(), data_.size());
     return *this;
   }
+
+  // this = base + sum_j coefficients[j] * terms[j], fused into a single pass.
+  // base may be *this.
+  void AssignCombination(const ParticleState& base,
+                         size_t count,
+                         const float* coefficients,
+                         const ParticleState* const* terms) {
+    const size_t kMaxTerms = 8;
+    if (count > kMaxTerms) {
+      throw std::runtime_error("Too many terms in particle state combination!");
+    }
+    const float* term_data[kMaxTerms];
+    for (size_t j = 0; j < count; j++) {
+      if (terms[j]->size_ != base.size_) {
+        throw std::runtime_error(
+            "Cannot combine particle states with inconsistent sizes!");
+      }
+      term_data[j] = terms[j]->data_.data();
+    }
+    Resize(base.size_);
+    ParallelKernelCombine(data_.data(), base.data_.data(), count,
+                          coefficients, term_data, data_.size());
+  }
+
+  // this = base + a * term.
+  void AssignAxpy(const ParticleState& base,
+                  float a,
+                  const ParticleState& term) {
+    const ParticleState* terms[] = {&term};
+    AssignCombination(base, 1, &a, terms);
+  }
+
+  // Velocity half of a split (symplectic) step: v += dt * a, with the
+  // accelerations taken from the velocity channels of derivative.
+  void Kick(const ParticleState& derivative, float dt) {
+    if (size_ != derivative.size_) {
+      throw std::runtime_error(
+          "Cannot kick a particle state with an inconsistent derivative!");
+    }
+    KernelAxpy(GetChannel(VelX), dt, derivative.GetChannel(VelX),
+               3 * stride_);
+  }
+
+  // Position half of a split step: x += dt * v, using this state's own
+  // velocities.
+  void Drift(float dt) {
+    KernelAxpy(GetChannel(PosX), dt, GetChannel(VelX), 3 * stride_);
+  }
+
+  // Largest component-wise difference to other, measured relative to the
+  // given tolerances (see KernelScaledMaxError). A result <= 1 means the two
+  // states agree to within tolerance.
+  float ScaledMaxError(const ParticleState& other,
+                       const ParticleState& reference,
+                       float abs_tol,
+                       float rel_tol) const {
+    if (size_ != other.size_ || size_ != reference.size_) {
+      throw std::runtime_error(
+          "Cannot compare particle states with inconsistent sizes!");
+    }
+    return KernelScaledMaxError(data_.data(), other.data_.data(),
+                                reference.data_.data(), abs_tol, rel_tol,
+                                data_.size());
+  }
+
+ private:
+  size_t size_;
+  size_t stride_;
+  AlignedFloatArray data_;
 };
 
 // Operators, optimized via overloading + std::move.
@@ -1,6 +1,8 @@
 #ifndef PARTICLE_SYSTEM_BASE_H_
 #define PARTICLE_SYSTEM_BASE_H_
 
+#include <limits>
+
 #include "ParticleState.hpp"
 
 namespace GLOO {
@@ -9,8 +11,25 @@ class ParticleSystemBase {
   virtual ~ParticleSystemBase() {
   }
 
-  virtual ParticleState ComputeTimeDerivative(const ParticleState& state,
-                                              float time) const = 0;
+  // Writes the derivative of state into derivative, resizing it if needed.
+  // Implementations must not allocate once derivative has the right size.
+  virtual void ComputeTimeDerivative(const ParticleState& state,
+                                     float time,
+                                     ParticleState& derivative) const = 0;
+
+  ParticleState ComputeTimeDerivative(const ParticleState& state,
+                                      float time) const {
+    ParticleState derivative;
+    ComputeTimeDerivative(state, time, derivative);
+    return derivative;
+  }
+
+  // Earliest time after time at which the derivative jumps (e.g. a force
+  // switching on or off). Adaptive integrators end their steps there instead
+  // of stepping across the discontinuity.
+  virtual float NextEventTime(float time) const {
+    return std::numeric_limits<float>::infinity();
+  }
 };
 }  // namespace GLOO
 
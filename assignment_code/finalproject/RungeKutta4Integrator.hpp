@@ -6,19 +6,35 @@
 namespace GLOO {
 template <class TSystem, class TState>
 class RungeKutta4Integrator : public IntegratorBase<TSystem, TState> {
-  TState Integrate(const TSystem& system,
-                   const TState& state,
-                   float start_time,
-                   float dt) const override {
-    // TODO: Here we are returning the state at time t (which is NOT what we
-    // want). Please replace the line below by the state at time t + dt using
-    // forward Euler integration.
-    auto k1 = system.ComputeTimeDerivative(state, start_time);
-    auto k2 = system.ComputeTimeDerivative(state + ((dt/2) * k1), start_time + (dt/2));
-    auto k3 = system.ComputeTimeDerivative(state + ((dt/2) * k2), start_time + (dt/2));
-    auto k4 = system.ComputeTimeDerivative(state + (dt * k3), start_time + dt);
-    auto next_state = state + ((dt/6) * (k1 + (2 * k2) + (2 * k3) + k4));
-    return next_state;
+ public:
+  using IntegratorBase<TSystem, TState>::Integrate;
+
+  void Integrate(const TSystem& system,
+                 TState& state,
+                 float start_time,
+                 float dt,
+                 IntegratorWorkspace<TState>& workspace) const override {
+    workspace.Prepare(4, state);
+    TState& k1 = workspace.stages[0];
+    TState& k2 = workspace.stages[1];
+    TState& k3 = workspace.stages[2];
+    TState& k4 = workspace.stages[3];
+    TState& stage = workspace.scratch;
+
+    // Each stage state is formed in one fused pass straight into the scratch
+    // buffer, and the final update accumulates all four slopes at once.
+    system.ComputeTimeDerivative(state, start_time, k1);
+    stage.AssignAxpy(state, dt / 2, k1);
+    system.ComputeTimeDerivative(stage, start_time + (dt / 2), k2);
+    stage.AssignAxpy(state, dt / 2, k2);
+    system.ComputeTimeDerivative(stage, start_time + (dt / 2), k3);
+    stage.AssignAxpy(state, dt, k3);
+    system.ComputeTimeDerivative(stage, start_time + dt, k4);
+
+    const float coefficients[] = {dt / 6, dt / 3, dt / 3, dt / 6};
+    const TState* slopes[] = {&k1, &k2, &k3, &k4};
+    state.AssignCombination(state, 4, coefficients, slopes);
+    workspace.num_evaluations += 4;
   }
 };
 }  // namespace GLOO
@@ -23,9 +23,11 @@
 namespace GLOO {
 SimulationApp::SimulationApp(const std::string& app_name,
                              glm::ivec2 window_size,
-                             float integration_step)
+                             float integration_step,
+                             IntegratorType integrator_type)
     : Application(app_name, window_size),
-      integration_step_(integration_step) {
+      integration_step_(integration_step),
+      integrator_type_(integrator_type) {
 }
 
 void SimulationApp::SetupScene() {
@@ -51,12 +53,12 @@ void SimulationApp::SetupScene() {
   root.AddChild(std::move(point_light_node));
 
   // Create Bunny Node
-  auto bunny_node = make_unique<BunnyNode>(integration_step_);
+  auto bunny_node = make_unique<BunnyNode>(integration_step_, integrator_type_);
   bunny_node->GetTransform().SetRotation(glm::quat(1.f, 0.f, 0.f, 0.f));
   root.AddChild(std::move(bunny_node));
 
   // Create Sphere Node
-  auto sphere_node = make_unique<SphereNode>(integration_step_);
+  auto sphere_node = make_unique<SphereNode>(integration_step_, integrator_type_);
   root.AddChild(std::move(sphere_node));
   
   // BunnyNode* bunny_pointer = bunny_node.get();
@@ -78,4 +80,28 @@ void SimulationApp::SetupScene() {
   // expl_node->GetTransform().SetPosition(glm::vec3(-5.f, 1.f, 0.f));
   // root.AddChild(std::move(expl_node));
 }
+
+void SimulationApp::DrawGUI() {
+  // Lets the two lighting paths be compared on the running scene.
+  Renderer& renderer = GetRenderer();
+  ImGui::Begin("Rendering", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+  bool single_pass = renderer.GetLightingMode() == LightingMode::SinglePass;
+  if (ImGui::Checkbox("Single-pass lighting", &single_pass)) {
+    renderer.SetLightingMode(single_pass ? LightingMode::SinglePass
+                                         : LightingMode::MultiPass);
+  }
+  const RenderStats& stats = renderer.GetStats();
+  ImGui::Text("Objects: %zu drawn, %zu culled", stats.objects_drawn,
+              stats.objects_culled);
+  ImGui::Text("Draw calls: %zu", stats.draw_calls);
+  ImGui::Text("Program binds: %zu (%zu saved)", stats.program_binds,
+              stats.program_binds_skipped);
+  ImGui::Text("VAO binds: %zu (%zu saved)", stats.vertex_array_binds,
+              stats.vertex_array_binds_skipped);
+  ImGui::Text("Material uploads: %zu (%zu saved)", stats.material_uploads,
+              stats.material_uploads_skipped);
+  float framerate = ImGui::GetIO().Framerate;
+  ImGui::Text("Frame time: %.2f ms (%.0f FPS)", 1000.f / framerate, framerate);
+  ImGui::End();
+}
 }  // namespace GLOO
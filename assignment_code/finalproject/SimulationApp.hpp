@@ -5,17 +5,23 @@
 
 #include "ParticleSystemBase.hpp"
 #include "ParticleState.hpp"
+#include "IntegratorFactory.hpp"
 
 namespace GLOO {
 class SimulationApp : public Application {
  public:
   SimulationApp(const std::string& app_name,
                 glm::ivec2 window_size,
-                float integration_step);
+                float integration_step,
+                IntegratorType integrator_type = IntegratorType::RK4);
   void SetupScene() override;
 
+ protected:
+  void DrawGUI() override;
+
  private:
   float integration_step_;
+  IntegratorType integrator_type_;
 };
 }  // namespace GLOO
 
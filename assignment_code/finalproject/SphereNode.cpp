@@ -9,8 +9,8 @@
 #include <fstream>
 
 namespace GLOO {
-    SphereNode::SphereNode(float integration_step): 
-        integration_step_(integration_step) {
+    SphereNode::SphereNode(float integration_step, IntegratorType integrator_type): 
+        integration_step_(integration_step), integrator_type_(integrator_type) {
         Init();
     }
 
@@ -39,14 +39,14 @@ namespace GLOO {
 
     void SphereNode::InitParticle() {
         auto initial_position = glm::vec3(-0.67f, 0.2f, 0.0f);
-        particle_state_.positions = {initial_position};
-        particle_state_.velocities = {glm::vec3(0.8f, 0.f, 0.f)};
+        particle_state_ = ParticleState::FromArrays({initial_position}, {glm::vec3(0.8f, 0.f, 0.f)});
+        workspace_.Invalidate();
 
         start_ = false;
     }
 
     void SphereNode::InitSystem() {
-        integrator_ = IntegratorFactory::CreateIntegrator<ParticleSystemBase, ParticleState>();
+        integrator_ = IntegratorFactory::CreateIntegrator<ParticleSystemBase, ParticleState>(integrator_type_);
         particle_system_ = ConstantSpeedSystem();
     }
 
@@ -56,8 +56,13 @@ namespace GLOO {
         if (start_) {
             int num_steps = (delta_time_ + carrier_time_step_)/integration_step_;
             carrier_time_step_ = delta_time_ + carrier_time_step_ - float(num_steps * integration_step_);
-            for (int i = 0; i < num_steps; i++) {
-                Advance(float(i * integration_step_));
+            if (integrator_->IsAdaptive()) {
+                // The ball flies freely, so one adaptive call covers the frame.
+                integrator_->Integrate(particle_system_, particle_state_, 0.f, float(num_steps * integration_step_), workspace_);
+            } else {
+                for (int i = 0; i < num_steps; i++) {
+                    Advance(float(i * integration_step_));
+                }
             }
             SetPositions();
         }
@@ -84,11 +89,10 @@ namespace GLOO {
     }
 
     void SphereNode::Advance(float start_time) {
-        auto next_state = integrator_->Integrate(particle_system_, particle_state_, start_time, integration_step_);
-        particle_state_ = next_state;
+        integrator_->Integrate(particle_system_, particle_state_, start_time, integration_step_, workspace_);
     }
 
     void SphereNode::SetPositions() {
-        GetTransform().SetPosition(particle_state_.positions[0]);
+        GetTransform().SetPosition(particle_state_.GetPosition(0));
     }
 }
\ No newline at end of file
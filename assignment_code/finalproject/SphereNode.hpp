@@ -3,6 +3,7 @@
 
 #include "gloo/SceneNode.hpp"
 #include "IntegratorBase.hpp"
+#include "IntegratorFactory.hpp"
 #include "ConstantSpeedSystem.hpp"
 #include "ParticleState.hpp"
 #include "gloo/shaders/MyShader.hpp"
@@ -13,7 +14,7 @@
 namespace GLOO {
     class SphereNode : public SceneNode {
         public:
-        SphereNode(float integration_step);
+        SphereNode(float integration_step, IntegratorType integrator_type = IntegratorType::RK4);
         void Update(double delta_time) override;
 
         private:
@@ -26,10 +27,12 @@ namespace GLOO {
 
         std::unique_ptr<IntegratorBase<ParticleSystemBase, ParticleState>> integrator_;
         ParticleState particle_state_;
+        IntegratorWorkspace<ParticleState> workspace_;
         ConstantSpeedSystem particle_system_;
 
         // step
         float integration_step_;
+        IntegratorType integrator_type_;
         float carrier_time_step_ = 0.f;
 
         SceneNode* sphere_pointer_;
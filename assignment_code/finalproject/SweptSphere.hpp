@@ -0,0 +1,195 @@
+#ifndef SWEPT_SPHERE_H_
+#define SWEPT_SPHERE_H_
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+namespace GLOO {
+struct SweptSphereHit {
+  // Time of first contact, relative to the start of the sweep.
+  float time;
+  // Contact point on the triangle and unit normal pointing from it towards
+  // the sphere center, both at the time of contact.
+  glm::vec3 point;
+  glm::vec3 normal;
+};
+
+// Closest point to p on triangle (a, b, c), from Ericson, "Real-Time
+// Collision Detection", 5.1.5.
+inline glm::vec3 ClosestPointOnTriangle(const glm::vec3& p,
+                                        const glm::vec3& a,
+                                        const glm::vec3& b,
+                                        const glm::vec3& c) {
+  glm::vec3 ab = b - a;
+  glm::vec3 ac = c - a;
+  glm::vec3 ap = p - a;
+  float d1 = glm::dot(ab, ap);
+  float d2 = glm::dot(ac, ap);
+  if (d1 <= 0.f && d2 <= 0.f)
+    return a;
+
+  glm::vec3 bp = p - b;
+  float d3 = glm::dot(ab, bp);
+  float d4 = glm::dot(ac, bp);
+  if (d3 >= 0.f && d4 <= d3)
+    return b;
+
+  float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+    return a + (d1 / (d1 - d3)) * ab;
+
+  glm::vec3 cp = p - c;
+  float d5 = glm::dot(ab, cp);
+  float d6 = glm::dot(ac, cp);
+  if (d6 >= 0.f && d5 <= d6)
+    return c;
+
+  float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+    return a + (d2 / (d2 - d6)) * ac;
+
+  float va = d3 * d6 - d5 * d4;
+  if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+    return b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b);
+
+  float denom = 1.f / (va + vb + vc);
+  return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+namespace detail {
+// Whether p, assumed to lie in the plane of (a, b, c), is inside the
+// triangle, by its barycentric coordinates.
+inline bool InsideTriangle(const glm::vec3& p,
+                           const glm::vec3& a,
+                           const glm::vec3& b,
+                           const glm::vec3& c) {
+  glm::vec3 v0 = b - a;
+  glm::vec3 v1 = c - a;
+  glm::vec3 v2 = p - a;
+  float d00 = glm::dot(v0, v0);
+  float d01 = glm::dot(v0, v1);
+  float d11 = glm::dot(v1, v1);
+  float d20 = glm::dot(v2, v0);
+  float d21 = glm::dot(v2, v1);
+  float denom = d00 * d11 - d01 * d01;
+  float v = (d11 * d20 - d01 * d21) / denom;
+  float w = (d00 * d21 - d01 * d20) / denom;
+  return v >= 0.f && w >= 0.f && v + w <= 1.f;
+}
+
+// Smallest root in [0, max_time] of qa * s^2 + 2 * qb * s + qc = 0, for a
+// distance function that starts outside (qc > 0) and approaches (qb < 0).
+inline bool FirstRoot(float qa, float qb, float qc, float max_time, float& s) {
+  if (qa <= 0.f || qb >= 0.f)
+    return false;
+  float discriminant = qb * qb - qa * qc;
+  if (discriminant < 0.f)
+    return false;
+  s = (-qb - std::sqrt(discriminant)) / qa;
+  return s >= 0.f && s <= max_time;
+}
+}  // namespace detail
+
+// Earliest time in [0, max_time] at which a sphere of the given radius,
+// starting at center and moving with constant velocity, touches the triangle
+// (a, b, c). The first contact is on the face interior, on an edge or at a
+// vertex; each case reduces to a linear or quadratic equation in time. A
+// sphere that already overlaps the triangle reports a hit at time 0.
+inline bool SweepSphereTriangle(const glm::vec3& center,
+                                float radius,
+                                const glm::vec3& velocity,
+                                float max_time,
+                                const glm::vec3& a,
+                                const glm::vec3& b,
+                                const glm::vec3& c,
+                                SweptSphereHit& hit) {
+  glm::vec3 closest = ClosestPointOnTriangle(center, a, b, c);
+  glm::vec3 offset = center - closest;
+  float distance2 = glm::dot(offset, offset);
+  if (distance2 <= radius * radius) {
+    glm::vec3 normal = glm::cross(b - a, c - a);
+    hit.time = 0.f;
+    hit.point = closest;
+    if (distance2 > 0.f)
+      hit.normal = offset / std::sqrt(distance2);
+    else if (glm::length(normal) > 0.f)
+      hit.normal = glm::normalize(normal);
+    else
+      hit.normal = glm::vec3(0.f, 1.f, 0.f);
+    return true;
+  }
+
+  bool found = false;
+  float best = max_time;
+
+  // Face interior.
+  glm::vec3 normal = glm::cross(b - a, c - a);
+  float normal_length = glm::length(normal);
+  if (normal_length > 0.f) {
+    normal /= normal_length;
+    float d0 = glm::dot(normal, center - a);
+    if (d0 < 0.f) {
+      normal = -normal;
+      d0 = -d0;
+    }
+    float approach = -glm::dot(normal, velocity);
+    if (approach > 0.f) {
+      float s = (d0 - radius) / approach;
+      if (s >= 0.f && s <= best) {
+        glm::vec3 point = center + s * velocity - radius * normal;
+        if (detail::InsideTriangle(point, a, b, c)) {
+          found = true;
+          best = s;
+          hit.point = point;
+          hit.normal = normal;
+        }
+      }
+    }
+  }
+
+  // Edges, as infinite cylinders clipped to the segment.
+  const glm::vec3* corners[] = {&a, &b, &c};
+  for (int i = 0; i < 3; i++) {
+    const glm::vec3& p = *corners[i];
+    glm::vec3 edge = *corners[(i + 1) % 3] - p;
+    float edge2 = glm::dot(edge, edge);
+    if (edge2 == 0.f)
+      continue;
+    glm::vec3 m = center - p;
+    glm::vec3 m_perp = m - (glm::dot(m, edge) / edge2) * edge;
+    glm::vec3 v_perp = velocity - (glm::dot(velocity, edge) / edge2) * edge;
+    float s;
+    if (!detail::FirstRoot(glm::dot(v_perp, v_perp), glm::dot(m_perp, v_perp),
+                           glm::dot(m_perp, m_perp) - radius * radius, best,
+                           s))
+      continue;
+    float u = glm::dot(m + s * velocity, edge) / edge2;
+    if (u < 0.f || u > 1.f)
+      continue;
+    found = true;
+    best = s;
+    hit.point = p + u * edge;
+    hit.normal = glm::normalize(center + s * velocity - hit.point);
+  }
+
+  // Vertices.
+  for (int i = 0; i < 3; i++) {
+    glm::vec3 m = center - *corners[i];
+    float s;
+    if (!detail::FirstRoot(glm::dot(velocity, velocity), glm::dot(m, velocity),
+                           glm::dot(m, m) - radius * radius, best, s))
+      continue;
+    found = true;
+    best = s;
+    hit.point = *corners[i];
+    hit.normal = glm::normalize(center + s * velocity - hit.point);
+  }
+
+  if (found)
+    hit.time = best;
+  return found;
+}
+}  // namespace GLOO
+
+#endif
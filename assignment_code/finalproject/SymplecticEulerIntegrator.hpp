@@ -0,0 +1,31 @@
+#ifndef SYMPLECTIC_EULER_INTEGRATOR_H_
+#define SYMPLECTIC_EULER_INTEGRATOR_H_
+
+#include "IntegratorBase.hpp"
+
+namespace GLOO {
+// Semi-implicit Euler: velocities are updated from the current forces, then
+// positions from the new velocities. First order, but symplectic and one
+// derivative evaluation per step.
+template <class TSystem, class TState>
+class SymplecticEulerIntegrator : public IntegratorBase<TSystem, TState> {
+ public:
+  using IntegratorBase<TSystem, TState>::Integrate;
+
+  void Integrate(const TSystem& system,
+                 TState& state,
+                 float start_time,
+                 float dt,
+                 IntegratorWorkspace<TState>& workspace) const override {
+    workspace.Prepare(1, state);
+    TState& derivative = workspace.stages[0];
+    system.ComputeTimeDerivative(state, start_time, derivative);
+    workspace.num_evaluations++;
+    state.Kick(derivative, dt);
+    state.Drift(dt);
+    workspace.derivative_valid = false;
+  }
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef UNIFORM_GRID_H_
+#define UNIFORM_GRID_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace GLOO {
+// Uniform grid over a set of points, rebuilt from scratch with a counting
+// sort (O(points + cells)) whenever the points move. Each point is stored in
+// the one cell that contains it, so objects with extent are found by growing
+// the query box by their largest radius. All buffers are reused across
+// rebuilds.
+class UniformGrid {
+ public:
+  void Build(const float* x,
+             const float* y,
+             const float* z,
+             size_t count,
+             float cell_size) {
+    count_ = count;
+    if (count == 0)
+      return;
+    bounds_min_ = glm::vec3(x[0], y[0], z[0]);
+    glm::vec3 bounds_max = bounds_min_;
+    for (size_t i = 1; i < count; i++) {
+      glm::vec3 p(x[i], y[i], z[i]);
+      bounds_min_ = glm::min(bounds_min_, p);
+      bounds_max = glm::max(bounds_max, p);
+    }
+
+    // Keep the number of cells proportional to the number of points, even if
+    // a few of them fly far away.
+    const size_t kMaxCellsPerPoint = 4;
+    glm::vec3 extent = bounds_max - bounds_min_;
+    cell_size_ = std::max(cell_size, 1e-6f);
+    while (true) {
+      for (int axis = 0; axis < 3; axis++) {
+        dims_[axis] = int(extent[axis] / cell_size_) + 1;
+      }
+      if (size_t(dims_[0]) * dims_[1] * dims_[2] <= kMaxCellsPerPoint * count)
+        break;
+      cell_size_ *= 2.f;
+    }
+    size_t num_cells = size_t(dims_[0]) * dims_[1] * dims_[2];
+
+    // The cell count changes as the points spread out; reserving its upper
+    // bound keeps rebuilds for the same number of points from allocating.
+    cell_start_.reserve(kMaxCellsPerPoint * count + 1);
+    cursor_.reserve(kMaxCellsPerPoint * count);
+    cell_start_.assign(num_cells + 1, 0);
+    point_cells_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+      uint32_t cell = CellIndex(CellOf(glm::vec3(x[i], y[i], z[i])));
+      point_cells_[i] = cell;
+      cell_start_[cell + 1]++;
+    }
+    for (size_t c = 0; c < num_cells; c++) {
+      cell_start_[c + 1] += cell_start_[c];
+    }
+    cell_points_.resize(count);
+    cursor_.assign(cell_start_.begin(), cell_start_.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+      cell_points_[cursor_[point_cells_[i]]++] = uint32_t(i);
+    }
+  }
+
+  // Appends to out the indices of all points that may lie in the box
+  // [box_min, box_max], in increasing index order.
+  void Query(const glm::vec3& box_min,
+             const glm::vec3& box_max,
+             std::vector<uint32_t>& out) const {
+    size_t first = out.size();
+    QueryUnordered(box_min, box_max, out);
+    std::sort(out.begin() + first, out.end());
+  }
+
+  // Same as Query, but in cell order, for callers that do not need the
+  // indices sorted.
+  void QueryUnordered(const glm::vec3& box_min,
+                      const glm::vec3& box_max,
+                      std::vector<uint32_t>& out) const {
+    if (count_ == 0)
+      return;
+    glm::ivec3 lo = CellOf(box_min);
+    glm::ivec3 hi = CellOf(box_max);
+    // CellOf clamps, so a box outside the grid would otherwise pick up the
+    // border cells.
+    glm::vec3 bounds_max =
+        bounds_min_ + cell_size_ * glm::vec3(dims_[0], dims_[1], dims_[2]);
+    for (int axis = 0; axis < 3; axis++) {
+      if (box_max[axis] < bounds_min_[axis] || box_min[axis] > bounds_max[axis])
+        return;
+    }
+    for (int k = lo.z; k <= hi.z; k++) {
+      for (int j = lo.y; j <= hi.y; j++) {
+        for (int i = lo.x; i <= hi.x; i++) {
+          uint32_t cell = CellIndex(glm::ivec3(i, j, k));
+          out.insert(out.end(), cell_points_.begin() + cell_start_[cell],
+                     cell_points_.begin() + cell_start_[cell + 1]);
+        }
+      }
+    }
+  }
+
+ private:
+  glm::ivec3 CellOf(const glm::vec3& p) const {
+    glm::ivec3 cell;
+    for (int axis = 0; axis < 3; axis++) {
+      int c = int(std::floor((p[axis] - bounds_min_[axis]) / cell_size_));
+      cell[axis] = std::max(0, std::min(dims_[axis] - 1, c));
+    }
+    return cell;
+  }
+
+  uint32_t CellIndex(const glm::ivec3& cell) const {
+    return uint32_t((cell.z * dims_[1] + cell.y) * dims_[0] + cell.x);
+  }
+
+  size_t count_ = 0;
+  glm::vec3 bounds_min_;
+  float cell_size_ = 1.f;
+  int dims_[3] = {1, 1, 1};
+  // CSR layout: the points of cell c are
+  // cell_points_[cell_start_[c] .. cell_start_[c + 1]).
+  std::vector<uint32_t> cell_start_;
+  std::vector<uint32_t> cell_points_;
+  std::vector<uint32_t> point_cells_;
+  std::vector<uint32_t> cursor_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef VELOCITY_VERLET_INTEGRATOR_H_
+#define VELOCITY_VERLET_INTEGRATOR_H_
+
+#include "IntegratorBase.hpp"
+
+namespace GLOO {
+// Velocity Verlet in kick-drift-kick form. Second order and symplectic for
+// position-dependent forces; velocity-dependent forces such as drag are
+// evaluated at the half-step velocity. The derivative at the end of a step is
+// cached in the workspace, so steady stepping costs one evaluation per step.
+template <class TSystem, class TState>
+class VelocityVerletIntegrator : public IntegratorBase<TSystem, TState> {
+ public:
+  using IntegratorBase<TSystem, TState>::Integrate;
+
+  void Integrate(const TSystem& system,
+                 TState& state,
+                 float start_time,
+                 float dt,
+                 IntegratorWorkspace<TState>& workspace) const override {
+    workspace.Prepare(1, state);
+    TState& derivative = workspace.stages[0];
+    if (!workspace.HasDerivativeAt(start_time, dt)) {
+      system.ComputeTimeDerivative(state, start_time, derivative);
+      workspace.num_evaluations++;
+    }
+    state.Kick(derivative, dt / 2);
+    state.Drift(dt);
+    system.ComputeTimeDerivative(state, start_time + dt, derivative);
+    workspace.num_evaluations++;
+    state.Kick(derivative, dt / 2);
+
+    workspace.derivative_valid = true;
+    workspace.derivative_time = start_time + dt;
+  }
+};
+}  // namespace GLOO
+
+#endif
@@ -3,12 +3,47 @@
 #include <string>
 #include <cstdio>
 #include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <thread>
 
 #include "SimulationApp.hpp"
+#include "gloo/ThreadPool.hpp"
 
 using namespace GLOO;
 
+namespace {
+// Parses the thread count argument, clamped to [1, number of cores].
+// Returns false if arg is not an integer.
+bool ParseNumThreads(const char* arg, size_t& num_threads) {
+  char* end;
+  errno = 0;
+  long value = std::strtol(arg, &end, 10);
+  if (end == arg || *end != '\0')
+    return false;
+  size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  if (value < 1)
+    num_threads = 1;
+  else if (errno == ERANGE || size_t(value) > max_threads)
+    num_threads = max_threads;
+  else
+    num_threads = size_t(value);
+  return true;
+}
+}  // namespace
+
 int main(int argc, char** argv) {
+  // Optional first argument: number of threads for the simulation.
+  if (argc > 1) {
+    size_t num_threads;
+    if (argc > 2 || !ParseNumThreads(argv[1], num_threads)) {
+      std::cerr << "Usage: " << argv[0] << " [num_threads]" << std::endl;
+      return 1;
+    }
+    ThreadPool::GetInstance().SetNumThreads(num_threads);
+  }
+
   std::unique_ptr<SimulationApp> app = make_unique<SimulationApp>(
       "FinalProject", glm::ivec2(1440, 900), 0.01);
 
@@ -0,0 +1,125 @@
+// Times ObjParser on a synthetic OBJ file: the legacy line-by-line parse
+// against the in-place sequential and parallel ones. The file is a grid of
+// n x n quads split into triangles, written next to the executable and
+// removed afterwards.
+//
+// Usage: obj_parser_bench [grid_size] [num_runs]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "gloo/ThreadPool.hpp"
+#include "gloo/parsers/ObjParser.hpp"
+
+using namespace GLOO;
+
+namespace {
+const char* kFileName = "obj_parser_bench.obj";
+
+bool WriteGrid(const std::string& file_name, int n) {
+  std::ofstream file(file_name);
+  if (!file)
+    return false;
+  char line[128];
+  for (int i = 0; i <= n; i++) {
+    for (int j = 0; j <= n; j++) {
+      float x = float(i) / float(n);
+      float z = float(j) / float(n);
+      float y = 0.1f * float((i * 7 + j * 13) % 17) / 17.f;
+      snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", x, y, z);
+      file << line;
+    }
+  }
+  for (int i = 0; i <= n; i++) {
+    for (int j = 0; j <= n; j++) {
+      file << "vn 0.000000 1.000000 0.000000\n";
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      // OBJ indices start at 1.
+      int a = i * (n + 1) + j + 1;
+      int b = a + 1;
+      int c = a + n + 1;
+      int d = c + 1;
+      snprintf(line, sizeof(line), "f %d//%d %d//%d %d//%d\n", a, a, b, b, c,
+               c);
+      file << line;
+      snprintf(line, sizeof(line), "f %d//%d %d//%d %d//%d\n", b, b, d, d, c,
+               c);
+      file << line;
+    }
+  }
+  return bool(file);
+}
+
+// Fastest of num_runs parses in milliseconds; result holds the last parse.
+double TimeParse(ObjParser::ParseMode mode,
+                 int num_runs,
+                 ObjParser::ParsedData& result) {
+  double best_ms = 0.0;
+  for (int run = 0; run < num_runs; run++) {
+    bool success = false;
+    auto start = std::chrono::steady_clock::now();
+    result = ObjParser::Parse(kFileName, success, mode);
+    auto end = std::chrono::steady_clock::now();
+    if (!success) {
+      std::fprintf(stderr, "Parse failed!\n");
+      std::exit(EXIT_FAILURE);
+    }
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    best_ms = run == 0 ? ms : std::min(best_ms, ms);
+  }
+  return best_ms;
+}
+
+bool SameMesh(const ObjParser::ParsedData& a, const ObjParser::ParsedData& b) {
+  return a.positions != nullptr && b.positions != nullptr &&
+         a.indices != nullptr && b.indices != nullptr &&
+         *a.positions == *b.positions && *a.indices == *b.indices;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  int grid_size = argc > 1 ? std::atoi(argv[1]) : 1000;
+  int num_runs = argc > 2 ? std::atoi(argv[2]) : 3;
+  if (grid_size < 1 || num_runs < 1) {
+    std::fprintf(stderr, "Usage: %s [grid_size] [num_runs]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (!WriteGrid(kFileName, grid_size)) {
+    std::fprintf(stderr, "Cannot write %s!\n", kFileName);
+    return EXIT_FAILURE;
+  }
+  std::ifstream written(kFileName, std::ios::binary | std::ios::ate);
+  std::printf("%d x %d grid: %d vertices, %d triangles, %.1f MB\n", grid_size,
+              grid_size, (grid_size + 1) * (grid_size + 1),
+              2 * grid_size * grid_size, double(written.tellg()) / 1e6);
+  std::printf("%zu threads, best of %d runs\n",
+              ThreadPool::GetInstance().GetNumThreads(), num_runs);
+
+  ObjParser::ParsedData legacy, sequential, parallel;
+  double legacy_ms = TimeParse(ObjParser::ParseMode::Legacy, num_runs, legacy);
+  double sequential_ms =
+      TimeParse(ObjParser::ParseMode::Sequential, num_runs, sequential);
+  double parallel_ms =
+      TimeParse(ObjParser::ParseMode::Parallel, num_runs, parallel);
+  std::remove(kFileName);
+
+  std::printf("legacy:     %8.1f ms\n", legacy_ms);
+  std::printf("sequential: %8.1f ms (%.1fx)\n", sequential_ms,
+              legacy_ms / sequential_ms);
+  std::printf("parallel:   %8.1f ms (%.1fx)\n", parallel_ms,
+              legacy_ms / parallel_ms);
+
+  if (!SameMesh(legacy, sequential) || !SameMesh(legacy, parallel)) {
+    std::fprintf(stderr, "The parsers disagree!\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -3,7 +3,9 @@
 #include <iostream>
 
 #include "gloo/utils.hpp"
+#include "gloo/AsyncLoader.hpp"
 #include "gloo/InputManager.hpp"
+#include "gloo/Profiler.hpp"
 
 namespace GLOO {
 Application::Application(std::string app_name, glm::ivec2 window_size)
@@ -16,10 +18,13 @@ Application::Application(std::string app_name, glm::ivec2 window_size)
 }
 
 Application::~Application() {
+  // Loads still in flight must not reach the scene or GL from here on.
+  AsyncLoader::GetInstance().Stop();
   // Release resources before destroying everything else.
   scene_.release();
   renderer_.release();
 
+  Profiler::GetInstance().ReleaseGpuQueries();
   DestroyGUI();
   glfwDestroyWindow(window_handle_);
   glfwTerminate();
@@ -92,6 +97,7 @@ void Application::UpdateGUI() {
   ImGui_ImplGlfw_NewFrame();
   ImGui::NewFrame();
   DrawGUI();
+  Profiler::GetInstance().DrawGUI();
 }
 
 void Application::RenderGUI() {
@@ -106,18 +112,45 @@ void Application::DestroyGUI() {
 }
 
 void Application::Tick(double delta_time, double current_time) {
+  Profiler& profiler = Profiler::GetInstance();
+  profiler.BeginFrame();
+
   // Process window events.
   glfwPollEvents();
-  UpdateGUI();
+  {
+    ScopedCpuTimer timer("GUI update");
+    UpdateGUI();
+  }
+
+  // Finish assets loaded in the background, so that the scene sees them in
+  // this update.
+  {
+    ScopedCpuTimer timer("Asset uploads");
+    AsyncLoader::GetInstance().RunMainThreadTasks();
+  }
 
   // Logic update before rendering.
-  scene_->Update(delta_time);
+  {
+    ScopedCpuTimer timer("Scene::Update");
+    scene_->Update(delta_time);
+  }
 
   // Rendering scene and GUI.
-  renderer_->Render(*scene_);
-  RenderGUI();
+  {
+    ScopedCpuTimer timer("Renderer::Render");
+    renderer_->Render(*scene_);
+  }
+  {
+    ScopedCpuTimer cpu_timer("GUI render");
+    ScopedGpuTimer gpu_timer("GUI render");
+    RenderGUI();
+  }
 
-  glfwSwapBuffers(window_handle_);
+  {
+    ScopedCpuTimer timer("Swap buffers");
+    glfwSwapBuffers(window_handle_);
+  }
+  profiler.EndFrame();
 }
 
 void Application::FramebufferSizeCallback(glm::ivec2 window_size) {
@@ -25,6 +25,9 @@ class Application {
   virtual void DrawGUI() {
   }
   virtual void SetupScene() = 0;
+  Renderer& GetRenderer() {
+    return *renderer_;
+  }
   std::unique_ptr<Scene> scene_;
 
  private:
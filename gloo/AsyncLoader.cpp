@@ -0,0 +1,72 @@
+#include "AsyncLoader.hpp"
+
+#include "ThreadPool.hpp"
+
+namespace GLOO {
+AsyncLoader::AsyncLoader() {
+  // Jobs may use the ThreadPool; constructing it first makes it outlive the
+  // loader threads.
+  ThreadPool::GetInstance();
+  for (size_t i = 0; i < kNumThreads; i++) {
+    workers_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+void AsyncLoader::Enqueue(std::function<void()> job) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_)
+      return;
+    jobs_.push_back(std::move(job));
+  }
+  job_ready_.notify_one();
+}
+
+void AsyncLoader::WorkerLoop() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      job_ready_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+      if (stopping_)
+        return;
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job();
+  }
+}
+
+void AsyncLoader::PostToMainThread(std::function<void()> fn) {
+  std::lock_guard<std::mutex> lock(main_thread_mutex_);
+  main_thread_tasks_.push_back(std::move(fn));
+}
+
+void AsyncLoader::RunMainThreadTasks() {
+  std::vector<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(main_thread_mutex_);
+    tasks.swap(main_thread_tasks_);
+  }
+  // Tasks posted while these run wait for the next call.
+  for (auto& task : tasks) {
+    task();
+  }
+}
+
+void AsyncLoader::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    jobs_.clear();
+  }
+  job_ready_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+
+  std::lock_guard<std::mutex> lock(main_thread_mutex_);
+  main_thread_tasks_.clear();
+}
+}  // namespace GLOO
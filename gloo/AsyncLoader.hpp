@@ -0,0 +1,81 @@
+#ifndef GLOO_ASYNC_LOADER_H_
+#define GLOO_ASYNC_LOADER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace GLOO {
+// Background threads for loading assets. Work that needs no GL context, such
+// as reading and parsing files, runs on the loader threads; work that does,
+// such as creating buffers, is posted back to the main thread and runs in
+// Application::Tick before the scene is updated.
+//
+// Futures of assets that finish on the main thread only become ready in a
+// later Tick, so the main thread must poll them (wait_for with a zero
+// timeout) rather than block on them.
+class AsyncLoader {
+ public:
+  // Singleton design pattern.
+  // AsyncLoader is initialized the first time GetInstance is called.
+  static AsyncLoader& GetInstance() {
+    static AsyncLoader _instance;
+    return _instance;
+  }
+
+  AsyncLoader(const AsyncLoader&) = delete;
+  void operator=(const AsyncLoader&) = delete;
+
+  // Runs fn on a loader thread. The future holds its result, or the
+  // exception it threw.
+  template <class Fn>
+  std::future<typename std::result_of<Fn()>::type> Submit(Fn fn) {
+    using Result = typename std::result_of<Fn()>::type;
+    // std::function needs a copyable target, and packaged_task is not one.
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+    std::future<Result> future = task->get_future();
+    Enqueue([task]() { (*task)(); });
+    return future;
+  }
+
+  // Queues fn to run on the main thread in the next Tick. May be called from
+  // any thread.
+  void PostToMainThread(std::function<void()> fn);
+  // Runs the functions queued so far. Called by Application::Tick.
+  void RunMainThreadTasks();
+
+  // Lets running jobs finish, drops queued jobs and main-thread functions,
+  // and joins the loader threads. Called before the GL context goes away.
+  void Stop();
+
+ private:
+  // Loading is mostly disk-bound and the OBJ parser spreads its own work
+  // over the ThreadPool, so a couple of threads are enough.
+  static const size_t kNumThreads = 2;
+
+  AsyncLoader();
+  ~AsyncLoader() {
+    Stop();
+  }
+
+  void Enqueue(std::function<void()> job);
+  void WorkerLoop();
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable job_ready_;
+  std::deque<std::function<void()>> jobs_;
+  bool stopping_{false};
+
+  std::mutex main_thread_mutex_;
+  std::vector<std::function<void()>> main_thread_tasks_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef GLOO_BOUNDING_BOX_H_
+#define GLOO_BOUNDING_BOX_H_
+
+#include <limits>
+
+#include <glm/glm.hpp>
+
+#include "alias_types.hpp"
+
+namespace GLOO {
+// Axis-aligned bounding box. A default-constructed box is empty: it has
+// min > max and contains nothing.
+struct BoundingBox {
+  glm::vec3 min{std::numeric_limits<float>::max()};
+  glm::vec3 max{-std::numeric_limits<float>::max()};
+
+  bool IsEmpty() const {
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+  }
+
+  void Extend(const glm::vec3& point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+  }
+
+  static BoundingBox FromPoints(const glm::vec3* points, size_t count) {
+    BoundingBox box;
+    for (size_t i = 0; i < count; i++) {
+      box.Extend(points[i]);
+    }
+    return box;
+  }
+
+  static BoundingBox FromPoints(const PositionArray& points) {
+    return FromPoints(points.data(), points.size());
+  }
+
+  // Smallest axis-aligned box containing this box transformed by matrix,
+  // computed from the center and half extents rather than the 8 corners.
+  BoundingBox Transformed(const glm::mat4& matrix) const {
+    if (IsEmpty())
+      return *this;
+    glm::vec3 center = 0.5f * (min + max);
+    glm::vec3 half_extent = 0.5f * (max - min);
+    glm::mat3 linear(matrix);
+    glm::mat3 abs_linear(glm::abs(linear[0]), glm::abs(linear[1]),
+                         glm::abs(linear[2]));
+    glm::vec3 new_center = linear * center + glm::vec3(matrix[3]);
+    glm::vec3 new_half_extent = abs_linear * half_extent;
+    BoundingBox box;
+    box.min = new_center - new_half_extent;
+    box.max = new_center + new_half_extent;
+    return box;
+  }
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,31 @@
+#include "Frustum.hpp"
+
+namespace GLOO {
+Frustum::Frustum(const glm::mat4& view_projection) {
+  // A point is inside when -w <= x, y, z <= w in clip space, which gives the
+  // planes as sums and differences of the rows of the matrix.
+  glm::vec4 rows[4];
+  for (int i = 0; i < 4; i++) {
+    rows[i] = glm::vec4(view_projection[0][i], view_projection[1][i],
+                        view_projection[2][i], view_projection[3][i]);
+  }
+  for (int i = 0; i < 3; i++) {
+    planes_[2 * i] = rows[3] + rows[i];
+    planes_[2 * i + 1] = rows[3] - rows[i];
+  }
+}
+
+bool Frustum::Intersects(const BoundingBox& box) const {
+  if (box.IsEmpty())
+    return false;
+  for (const glm::vec4& plane : planes_) {
+    // The corner of the box furthest along the plane normal.
+    glm::vec3 corner(plane.x > 0.f ? box.max.x : box.min.x,
+                     plane.y > 0.f ? box.max.y : box.min.y,
+                     plane.z > 0.f ? box.max.z : box.min.z);
+    if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.f)
+      return false;
+  }
+  return true;
+}
+}  // namespace GLOO
@@ -0,0 +1,26 @@
+#ifndef GLOO_FRUSTUM_H_
+#define GLOO_FRUSTUM_H_
+
+#include <glm/glm.hpp>
+
+#include "BoundingBox.hpp"
+
+namespace GLOO {
+// The six clipping planes of a view-projection matrix, in the space the
+// matrix maps from (world space for projection * view).
+class Frustum {
+ public:
+  explicit Frustum(const glm::mat4& view_projection);
+
+  // False only if box lies entirely outside one of the planes. Boxes near a
+  // corner of the frustum may be reported as intersecting although they are
+  // not, which only costs a draw.
+  bool Intersects(const BoundingBox& box) const;
+
+ private:
+  // Each plane is (n, d) with n . p + d >= 0 for points p inside.
+  glm::vec4 planes_[6];
+};
+}  // namespace GLOO
+
+#endif
@@ -7,6 +7,7 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
+#include "gloo/AsyncLoader.hpp"
 #include "gloo/utils.hpp"
 
 namespace {
@@ -81,4 +82,11 @@ std::unique_ptr<Image> Image::LoadPNG(const std::string& filename,
   stbi_image_free(buffer);
   return image;
 }
+
+std::future<std::unique_ptr<Image>> Image::LoadPNGAsync(
+    const std::string& filename,
+    bool y_reversed) {
+  return AsyncLoader::GetInstance().Submit(
+      [filename, y_reversed]() { return LoadPNG(filename, y_reversed); });
+}
 }  // namespace GLOO
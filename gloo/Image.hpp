@@ -1,6 +1,7 @@
 #ifndef GLOO_IMAGE_H_
 #define GLOO_IMAGE_H_
 
+#include <future>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
@@ -45,6 +46,10 @@ class Image {
 
   static std::unique_ptr<Image> LoadPNG(const std::string& filename,
                                         bool y_reversed);
+  // Same as LoadPNG, run on an AsyncLoader thread.
+  static std::future<std::unique_ptr<Image>> LoadPNGAsync(
+      const std::string& filename,
+      bool y_reversed);
   void SavePNG(const std::string& filename) const;
   std::vector<uint8_t> ToByteData() const;
   std::vector<float> ToFloatData() const;
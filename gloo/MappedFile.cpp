@@ -0,0 +1,68 @@
+#include "MappedFile.hpp"
+
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GLOO {
+MappedFile::~MappedFile() {
+  Close();
+}
+
+bool MappedFile::Open(const std::string& file_path) {
+  Close();
+#ifndef _WIN32
+  int fd = open(file_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  size_ = size_t(st.st_size);
+  if (size_ > 0) {
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      size_ = 0;
+      return false;
+    }
+    // Files are normally read front to back.
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(data);
+    mapped_ = true;
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  return true;
+#else
+  std::ifstream fs(file_path, std::ios::binary | std::ios::ate);
+  if (!fs)
+    return false;
+  buffer_.resize(size_t(fs.tellg()));
+  fs.seekg(0);
+  if (!fs.read(buffer_.data(), buffer_.size()))
+    return false;
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  return true;
+#endif
+}
+
+void MappedFile::Close() {
+#ifndef _WIN32
+  if (mapped_)
+    munmap(const_cast<char*>(data_), size_);
+#endif
+  mapped_ = false;
+  buffer_.clear();
+  data_ = nullptr;
+  size_ = 0;
+}
+}  // namespace GLOO
@@ -0,0 +1,41 @@
+#ifndef GLOO_MAPPED_FILE_H_
+#define GLOO_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace GLOO {
+// Read-only view of a whole file. On POSIX systems the file is memory-mapped,
+// so pages are read in lazily by the OS and nothing is copied; elsewhere the
+// file is read into memory.
+class MappedFile {
+ public:
+  MappedFile() {
+  }
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Returns false if the file cannot be opened or read.
+  bool Open(const std::string& file_path);
+  void Close();
+
+  const char* GetData() const {
+    return data_;
+  }
+  size_t GetSize() const {
+    return size_;
+  }
+
+ private:
+  const char* data_{nullptr};
+  size_t size_{0};
+  // Set when data_ points into a mapping rather than into buffer_.
+  bool mapped_{false};
+  std::vector<char> buffer_;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,401 @@
+#include "MeshCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+namespace GLOO {
+namespace {
+const char kMagic[8] = {'G', 'L', 'O', 'O', 'M', 'E', 'S', 'H'};
+const uint32_t kVersion = 1;
+
+enum Block {
+  kPositions,
+  kNormals,
+  kTexCoords,
+  kIndices,
+  kMaterials,
+  kGroups,
+  kStrings,
+  kNumBlocks
+};
+
+struct BlockRecord {
+  uint64_t offset;
+  uint64_t count;
+};
+
+struct HeaderRecord {
+  char magic[8];
+  uint32_t version;
+  // 1 if the arrays went through the MeshOptimizer.
+  uint32_t optimized;
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint64_t source_hash;
+  BlockRecord blocks[kNumBlocks];
+};
+
+struct MaterialRecord {
+  float ambient[3];
+  float diffuse[3];
+  float specular[3];
+  float shininess;
+};
+
+// Names are ranges of the string block.
+struct GroupRecord {
+  uint64_t start_face_index;
+  uint64_t num_indices;
+  uint32_t name_offset;
+  uint32_t name_length;
+  uint32_t material_name_offset;
+  uint32_t material_name_length;
+  // Index into the material block, or -1.
+  int32_t material;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float),
+              "Mesh cache blocks assume tightly packed vectors.");
+static_assert(sizeof(glm::vec2) == 2 * sizeof(float),
+              "Mesh cache blocks assume tightly packed vectors.");
+
+const size_t kElementSizes[kNumBlocks] = {
+    sizeof(glm::vec3),    sizeof(glm::vec3),      sizeof(glm::vec2),
+    sizeof(unsigned int), sizeof(MaterialRecord), sizeof(GroupRecord),
+    sizeof(char)};
+
+uint64_t AlignUp(uint64_t offset) {
+  const uint64_t kMask = MeshCache::kBlockAlignment - 1;
+  return (offset + kMask) & ~kMask;
+}
+
+bool GetSourceStamp(const std::string& source_path,
+                    uint64_t& size,
+                    int64_t& mtime) {
+  struct stat st;
+  if (stat(source_path.c_str(), &st) != 0)
+    return false;
+  size = uint64_t(st.st_size);
+  mtime = int64_t(st.st_mtime);
+  return true;
+}
+
+// 64-bit FNV-1a.
+bool HashFile(const std::string& file_path, uint64_t& hash) {
+  MappedFile file;
+  if (!file.Open(file_path))
+    return false;
+  hash = 14695981039346656037ull;
+  const unsigned char* data =
+      reinterpret_cast<const unsigned char*>(file.GetData());
+  for (size_t i = 0; i < file.GetSize(); i++) {
+    hash = (hash ^ data[i]) * 1099511628211ull;
+  }
+  return true;
+}
+
+// Records a new source modification time in the header of the cache at
+// cache_path, so that the source is not hashed again on the next load. A
+// failure only costs that hash.
+void UpdateSourceMtime(const std::string& cache_path, int64_t mtime) {
+  std::fstream file(cache_path,
+                    std::ios::binary | std::ios::in | std::ios::out);
+  if (!file)
+    return;
+  file.seekp(std::streamoff(offsetof(HeaderRecord, source_mtime)));
+  file.write(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+}
+
+// A name next to path that no other writer uses, so that concurrent
+// writers of the same cache do not interleave.
+std::string GetTempPath(const std::string& path) {
+  static std::atomic<unsigned int> counter(0);
+  std::ostringstream temp_path;
+  temp_path << path << ".tmp." << std::hex
+            << std::hash<std::thread::id>()(std::this_thread::get_id()) << '.'
+            << std::chrono::steady_clock::now().time_since_epoch().count()
+            << '.' << counter++;
+  return temp_path.str();
+}
+
+void CopyVec3(float* dst, const glm::vec3& v) {
+  dst[0] = v.x;
+  dst[1] = v.y;
+  dst[2] = v.z;
+}
+
+uint32_t AppendString(std::string& strings, const std::string& s) {
+  uint32_t offset = uint32_t(strings.size());
+  strings += s;
+  return offset;
+}
+}  // namespace
+
+std::string MeshCache::GetCachePath(const std::string& source_path) {
+  return source_path + ".meshcache";
+}
+
+bool MeshCache::Write(const std::string& source_path,
+                      const ObjParser::ParsedData& data,
+                      bool optimized) {
+  HeaderRecord header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.optimized = optimized ? 1 : 0;
+  if (!GetSourceStamp(source_path, header.source_size, header.source_mtime) ||
+      !HashFile(source_path, header.source_hash)) {
+    return false;
+  }
+
+  std::vector<MaterialRecord> materials;
+  std::unordered_map<const Material*, int32_t> material_ids;
+  std::vector<GroupRecord> groups;
+  std::string strings;
+  for (const MeshGroup& group : data.groups) {
+    GroupRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.start_face_index = group.start_face_index;
+    record.num_indices = group.num_indices;
+    record.name_offset = AppendString(strings, group.name);
+    record.name_length = uint32_t(group.name.size());
+    record.material_name_offset = AppendString(strings, group.material_name);
+    record.material_name_length = uint32_t(group.material_name.size());
+    record.material = -1;
+    if (group.material != nullptr) {
+      auto inserted = material_ids.emplace(group.material.get(),
+                                           int32_t(materials.size()));
+      if (inserted.second) {
+        MaterialRecord material;
+        CopyVec3(material.ambient, group.material->GetAmbientColor());
+        CopyVec3(material.diffuse, group.material->GetDiffuseColor());
+        CopyVec3(material.specular, group.material->GetSpecularColor());
+        material.shininess = group.material->GetShininess();
+        materials.push_back(material);
+      }
+      record.material = inserted.first->second;
+    }
+    groups.push_back(record);
+  }
+
+  const void* block_data[kNumBlocks] = {
+      data.positions ? data.positions->data() : nullptr,
+      data.normals ? data.normals->data() : nullptr,
+      data.tex_coords ? data.tex_coords->data() : nullptr,
+      data.indices ? data.indices->data() : nullptr,
+      materials.data(),
+      groups.data(),
+      strings.data()};
+  size_t block_counts[kNumBlocks] = {
+      data.positions ? data.positions->size() : 0,
+      data.normals ? data.normals->size() : 0,
+      data.tex_coords ? data.tex_coords->size() : 0,
+      data.indices ? data.indices->size() : 0,
+      materials.size(),
+      groups.size(),
+      strings.size()};
+  uint64_t offset = AlignUp(sizeof(HeaderRecord));
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    header.blocks[i].offset = offset;
+    header.blocks[i].count = block_counts[i];
+    offset = AlignUp(offset + block_counts[i] * kElementSizes[i]);
+  }
+
+  std::string cache_path = GetCachePath(source_path);
+  std::string temp_path = GetTempPath(cache_path);
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file)
+      return false;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t written = sizeof(header);
+    const char kPadding[kBlockAlignment] = {};
+    for (size_t i = 0; i < kNumBlocks; i++) {
+      file.write(kPadding, std::streamsize(header.blocks[i].offset - written));
+      uint64_t num_bytes = block_counts[i] * kElementSizes[i];
+      if (num_bytes > 0) {
+        file.write(static_cast<const char*>(block_data[i]),
+                   std::streamsize(num_bytes));
+      }
+      written = header.blocks[i].offset + num_bytes;
+    }
+    if (!file) {
+      file.close();
+      std::remove(temp_path.c_str());
+      return false;
+    }
+  }
+#ifdef _WIN32
+  // rename does not replace existing files on Windows.
+  std::remove(cache_path.c_str());
+#endif
+  if (std::rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool MeshCache::Open(const std::string& source_path, bool optimized) {
+  Close();
+  if (!file_.Open(GetCachePath(source_path)))
+    return false;
+  if (!IsValid(source_path, optimized)) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+bool MeshCache::IsValid(const std::string& source_path,
+                        bool optimized) const {
+  if (file_.GetSize() < sizeof(HeaderRecord))
+    return false;
+  const HeaderRecord& header =
+      *reinterpret_cast<const HeaderRecord*>(file_.GetData());
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.optimized != (optimized ? 1 : 0)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    const BlockRecord& block = header.blocks[i];
+    if (block.offset % kBlockAlignment != 0 || block.offset > file_.GetSize() ||
+        block.count > (file_.GetSize() - block.offset) / kElementSizes[i]) {
+      return false;
+    }
+  }
+  const GroupRecord* groups =
+      reinterpret_cast<const GroupRecord*>(GetBlock(kGroups));
+  for (size_t i = 0; i < GetCount(kGroups); i++) {
+    const GroupRecord& group = groups[i];
+    if (group.start_face_index > GetCount(kIndices) ||
+        group.num_indices > GetCount(kIndices) - group.start_face_index ||
+        uint64_t(group.name_offset) + group.name_length >
+            GetCount(kStrings) ||
+        uint64_t(group.material_name_offset) + group.material_name_length >
+            GetCount(kStrings) ||
+        group.material < -1 ||
+        group.material >= int64_t(GetCount(kMaterials))) {
+      return false;
+    }
+  }
+
+  uint64_t source_size;
+  int64_t source_mtime;
+  if (!GetSourceStamp(source_path, source_size, source_mtime) ||
+      source_size != header.source_size) {
+    return false;
+  }
+  if (source_mtime != header.source_mtime) {
+    uint64_t source_hash;
+    if (!HashFile(source_path, source_hash) ||
+        source_hash != header.source_hash) {
+      return false;
+    }
+    UpdateSourceMtime(GetCachePath(source_path), source_mtime);
+  }
+
+  // Checked last, since it reads the whole index block.
+  const unsigned int* indices = GetIndices();
+  return GetNumIndices() == 0 ||
+         *std::max_element(indices, indices + GetNumIndices()) <
+             GetNumPositions();
+}
+
+const char* MeshCache::GetBlock(size_t block) const {
+  const HeaderRecord& header =
+      *reinterpret_cast<const HeaderRecord*>(file_.GetData());
+  return file_.GetData() + header.blocks[block].offset;
+}
+
+size_t MeshCache::GetCount(size_t block) const {
+  const HeaderRecord& header =
+      *reinterpret_cast<const HeaderRecord*>(file_.GetData());
+  return size_t(header.blocks[block].count);
+}
+
+const glm::vec3* MeshCache::GetPositions() const {
+  return GetCount(kPositions) == 0
+             ? nullptr
+             : reinterpret_cast<const glm::vec3*>(GetBlock(kPositions));
+}
+
+const glm::vec3* MeshCache::GetNormals() const {
+  return GetCount(kNormals) == 0
+             ? nullptr
+             : reinterpret_cast<const glm::vec3*>(GetBlock(kNormals));
+}
+
+const glm::vec2* MeshCache::GetTexCoords() const {
+  return GetCount(kTexCoords) == 0
+             ? nullptr
+             : reinterpret_cast<const glm::vec2*>(GetBlock(kTexCoords));
+}
+
+const unsigned int* MeshCache::GetIndices() const {
+  return GetCount(kIndices) == 0
+             ? nullptr
+             : reinterpret_cast<const unsigned int*>(GetBlock(kIndices));
+}
+
+size_t MeshCache::GetNumPositions() const {
+  return GetCount(kPositions);
+}
+
+size_t MeshCache::GetNumNormals() const {
+  return GetCount(kNormals);
+}
+
+size_t MeshCache::GetNumTexCoords() const {
+  return GetCount(kTexCoords);
+}
+
+size_t MeshCache::GetNumIndices() const {
+  return GetCount(kIndices);
+}
+
+std::vector<MeshGroup> MeshCache::GetGroups() const {
+  const MaterialRecord* material_records =
+      reinterpret_cast<const MaterialRecord*>(GetBlock(kMaterials));
+  std::vector<std::shared_ptr<Material>> materials;
+  for (size_t i = 0; i < GetCount(kMaterials); i++) {
+    const MaterialRecord& record = material_records[i];
+    materials.push_back(std::make_shared<Material>(
+        glm::vec3(record.ambient[0], record.ambient[1], record.ambient[2]),
+        glm::vec3(record.diffuse[0], record.diffuse[1], record.diffuse[2]),
+        glm::vec3(record.specular[0], record.specular[1], record.specular[2]),
+        record.shininess));
+  }
+
+  const GroupRecord* group_records =
+      reinterpret_cast<const GroupRecord*>(GetBlock(kGroups));
+  const char* strings = GetBlock(kStrings);
+  std::vector<MeshGroup> groups;
+  for (size_t i = 0; i < GetCount(kGroups); i++) {
+    const GroupRecord& record = group_records[i];
+    MeshGroup group;
+    group.name = std::string(strings + record.name_offset, record.name_length);
+    group.start_face_index = size_t(record.start_face_index);
+    group.num_indices = size_t(record.num_indices);
+    group.material_name = std::string(strings + record.material_name_offset,
+                                      record.material_name_length);
+    if (record.material >= 0)
+      group.material = materials[record.material];
+    groups.push_back(group);
+  }
+  return groups;
+}
+}  // namespace GLOO
@@ -0,0 +1,82 @@
+#ifndef GLOO_MESH_CACHE_H_
+#define GLOO_MESH_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "MappedFile.hpp"
+#include "MeshData.hpp"
+#include "parsers/ObjParser.hpp"
+
+namespace GLOO {
+// Binary copy of an imported mesh, kept next to its source file as
+// <source>.meshcache. The file starts with a fixed header followed by the
+// position, normal, texture coordinate and index blocks in the exact layout
+// of the arrays they come from, each aligned to kBlockAlignment, so that a
+// mapped cache can be handed to GL as is. Groups and their materials
+// come last. Values are stored in the byte order of the machine that wrote
+// the cache; it is not meant to be shared between machines.
+//
+// The header records the size, modification time and a hash of the source.
+// A cache is used when size and time match; when only the time differs the
+// source is hashed, so that touching or copying the file does not force a
+// reparse, and on a match the new time is written back so that the hash is
+// not repeated. Every index must name an existing position and every group
+// must lie within the indices. Material libraries are not tracked: delete
+// the cache after editing one. The header also records whether the mesh
+// went through the MeshOptimizer, and a cache is only used for loads that
+// ask for the same.
+class MeshCache {
+ public:
+  static const size_t kBlockAlignment = 16;
+
+  MeshCache() {
+  }
+
+  static std::string GetCachePath(const std::string& source_path);
+
+  // Writes the cache of source_path for data, which was optimized or not.
+  // The file is written under a temporary name unique to the call and
+  // renamed, so readers never see a partial cache and concurrent writers do
+  // not clobber each other's file. Returns false if it cannot be written.
+  static bool Write(const std::string& source_path,
+                    const ObjParser::ParsedData& data,
+                    bool optimized);
+
+  // Maps the cache of source_path. Returns false if there is none, if it is
+  // stale or malformed, or if it was not written with the same optimized.
+  bool Open(const std::string& source_path, bool optimized);
+  void Close() {
+    file_.Close();
+  }
+
+  // Pointers into the mapping; valid until Close. nullptr if the mesh has no
+  // such data.
+  const glm::vec3* GetPositions() const;
+  const glm::vec3* GetNormals() const;
+  const glm::vec2* GetTexCoords() const;
+  const unsigned int* GetIndices() const;
+  size_t GetNumPositions() const;
+  size_t GetNumNormals() const;
+  size_t GetNumTexCoords() const;
+  size_t GetNumIndices() const;
+
+  // Groups with their materials; groups that shared a material in the
+  // source share one here too.
+  std::vector<MeshGroup> GetGroups() const;
+
+ private:
+  // Start and number of elements of one of the blocks listed in the
+  // header.
+  const char* GetBlock(size_t block) const;
+  size_t GetCount(size_t block) const;
+  bool IsValid(const std::string& source_path, bool optimized) const;
+
+  MappedFile file_;
+};
+}  // namespace GLOO
+
+#endif
@@ -3,25 +3,140 @@
 #include <iostream>
 #include <algorithm>
 
+#include "gloo/AsyncLoader.hpp"
+#include "gloo/MeshOptimizer.hpp"
 #include "gloo/utils.hpp"
 
 namespace GLOO {
-MeshData MeshLoader::Import(const std::string& filename) {
-  std::string file_path = GetAssetDir() + filename;
+namespace {
+template <class T>
+std::unique_ptr<std::vector<T>> CopyArray(const T* data, size_t count) {
+  if (count == 0)
+    return nullptr;
+  return make_unique<std::vector<T>>(data, data + count);
+}
+
+void UploadCache(const MeshCache& cache, VertexObject& vertex_obj) {
+  // GL copies the data straight out of the mapping.
+  if (cache.GetNumPositions() > 0) {
+    vertex_obj.UploadPositions(cache.GetPositions(), cache.GetNumPositions());
+  }
+  if (cache.GetNumNormals() > 0) {
+    vertex_obj.UploadNormals(cache.GetNormals(), cache.GetNumNormals());
+  }
+  if (cache.GetNumTexCoords() > 0) {
+    vertex_obj.UploadTexCoords(cache.GetTexCoords(), cache.GetNumTexCoords());
+  }
+  if (cache.GetNumIndices() > 0) {
+    vertex_obj.UploadIndices(cache.GetIndices(), cache.GetNumIndices());
+  }
+}
+
+ObjParser::ParsedData CopyCache(const MeshCache& cache) {
+  ObjParser::ParsedData data;
+  data.positions = CopyArray(cache.GetPositions(), cache.GetNumPositions());
+  data.normals = CopyArray(cache.GetNormals(), cache.GetNumNormals());
+  data.tex_coords = CopyArray(cache.GetTexCoords(), cache.GetNumTexCoords());
+  data.indices = CopyArray(cache.GetIndices(), cache.GetNumIndices());
+  data.groups = cache.GetGroups();
+  return data;
+}
+}  // namespace
+
+MeshData MeshLoader::Import(const std::string& filename,
+                            const MeshLoadOptions& options) {
   bool success;
-  auto parsed_data = ObjParser::Parse(file_path, success);
+  LoadedMesh mesh = Load(filename, success, options);
+  if (!success)
+    return {};
+  return Upload(mesh);
+}
+
+std::future<MeshData> MeshLoader::ImportAsync(const std::string& filename,
+                                              const MeshLoadOptions& options) {
+  auto promise = std::make_shared<std::promise<MeshData>>();
+  std::future<MeshData> future = promise->get_future();
+  AsyncLoader::GetInstance().Submit([filename, options, promise]() {
+    std::shared_ptr<LoadedMesh> mesh;
+    bool success;
+    try {
+      mesh = std::make_shared<LoadedMesh>(Load(filename, success, options));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+      return;
+    }
+    // A cached mesh stays mapped until Upload sends it to GL.
+    AsyncLoader::GetInstance().PostToMainThread([mesh, success, promise]() {
+      try {
+        promise->set_value(success ? Upload(*mesh) : MeshData());
+      } catch (...) {
+        promise->set_exception(std::current_exception());
+      }
+    });
+  });
+  return future;
+}
+
+LoadedMesh MeshLoader::Load(const std::string& filename,
+                            bool& success,
+                            const MeshLoadOptions& options) {
+  std::string file_path = GetAssetDir() + filename;
+  LoadedMesh mesh;
+  mesh.cache = make_unique<MeshCache>();
+  if (mesh.cache->Open(file_path, options.optimize)) {
+    success = true;
+    return mesh;
+  }
+  mesh.cache.reset();
+
+  mesh.parsed =
+      ObjParser::Parse(file_path, success, ObjParser::ParseMode::Parallel);
   if (!success) {
     std::cerr << "Load mesh file " << filename << " failed!" << std::endl;
-    return {};
+    return mesh;
+  }
+  if (options.optimize) {
+    MeshOptimizeStats stats = MeshOptimizer::Optimize(mesh.parsed);
+    // Meshes the optimizer cannot handle are left as they are.
+    if (options.print_stats && stats.triangles_before > 0)
+      std::cerr << "Optimized " << filename << ": " << stats.vertices_before
+                << " -> " << stats.vertices_after << " vertices, "
+                << stats.triangles_before << " -> " << stats.triangles_after
+                << " triangles, ACMR " << stats.acmr_before << " -> "
+                << stats.acmr_after << std::endl;
   }
   // Remove empty groups.
-  parsed_data.groups.erase(
-      std::remove_if(parsed_data.groups.begin(), parsed_data.groups.end(),
+  mesh.parsed.groups.erase(
+      std::remove_if(mesh.parsed.groups.begin(), mesh.parsed.groups.end(),
                      [](MeshGroup& g) { return g.num_indices == 0; }),
-      parsed_data.groups.end());
+      mesh.parsed.groups.end());
 
+  if (!MeshCache::Write(file_path, mesh.parsed, options.optimize)) {
+    std::cerr << "Cannot write mesh cache for " << filename << "!"
+              << std::endl;
+  }
+  return mesh;
+}
+
+ObjParser::ParsedData MeshLoader::LoadArrays(const std::string& filename,
+                                             bool& success,
+                                             const MeshLoadOptions& options) {
+  LoadedMesh mesh = Load(filename, success, options);
+  if (mesh.cache != nullptr)
+    return CopyCache(*mesh.cache);
+  return std::move(mesh.parsed);
+}
+
+MeshData MeshLoader::Upload(LoadedMesh& mesh) {
   MeshData mesh_data;
   mesh_data.vertex_obj = make_unique<VertexObject>();
+  if (mesh.cache != nullptr) {
+    UploadCache(*mesh.cache, *mesh_data.vertex_obj);
+    mesh_data.groups = mesh.cache->GetGroups();
+    return mesh_data;
+  }
+
+  ObjParser::ParsedData& parsed_data = mesh.parsed;
   if (parsed_data.positions) {
     mesh_data.vertex_obj->UpdatePositions(std::move(parsed_data.positions));
   }
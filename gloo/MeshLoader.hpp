@@ -1,13 +1,56 @@
 #ifndef GLOO_MESH_LOADER_H_
 #define GLOO_MESH_LOADER_H_
 
+#include <future>
+#include <memory>
+
 #include "parsers/ObjParser.hpp"
+#include "MeshCache.hpp"
 #include "MeshData.hpp"
 
 namespace GLOO {
+// A mesh read from disk but not yet sent to GL: either parsed from the OBJ
+// file or mapped from its MeshCache.
+struct LoadedMesh {
+  ObjParser::ParsedData parsed;
+  std::unique_ptr<MeshCache> cache;
+};
+
+struct MeshLoadOptions {
+  // Run a freshly parsed mesh through MeshOptimizer::Optimize before it is
+  // cached. Optimized and plain loads of a file do not share a cache.
+  bool optimize = false;
+  // Report the optimizer's statistics on std::cerr.
+  bool print_stats = false;
+};
+
 class MeshLoader {
  public:
-  static MeshData Import(const std::string& filename);
+  // Loads an OBJ file from the asset directory. The first import writes a
+  // MeshCache next to the file and later ones load that instead. A cached
+  // mesh is uploaded to GL straight from the mapped cache, so its
+  // VertexObject keeps no CPU copy of the arrays (Has* returns false).
+  static MeshData Import(const std::string& filename,
+                         const MeshLoadOptions& options = MeshLoadOptions());
+  // Same as Import, with the file loaded on an AsyncLoader thread and the
+  // GL objects created on the main thread in a later Tick. The mesh is
+  // empty if loading failed.
+  static std::future<MeshData> ImportAsync(
+      const std::string& filename,
+      const MeshLoadOptions& options = MeshLoadOptions());
+
+  // The two halves of Import. Load touches no GL state and may run on any
+  // thread; Upload creates the VertexObject and must run on the main thread.
+  static LoadedMesh Load(const std::string& filename,
+                         bool& success,
+                         const MeshLoadOptions& options = MeshLoadOptions());
+  static MeshData Upload(LoadedMesh& mesh);
+  // Load for callers that process the arrays on the CPU before uploading
+  // them themselves. Arrays of a cached mesh are copied out of the cache.
+  static ObjParser::ParsedData LoadArrays(
+      const std::string& filename,
+      bool& success,
+      const MeshLoadOptions& options = MeshLoadOptions());
 };
 }  // namespace GLOO
 
@@ -0,0 +1,439 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "BoundingBox.hpp"
+
+namespace GLOO {
+namespace {
+const uint32_t kUnused = uint32_t(-1);
+
+// Size of the LRU cache that the triangle order is tuned for, and the
+// scoring constants from Forsyth's article.
+const size_t kMaxCacheSize = 32;
+const float kCacheDecayPower = 1.5f;
+const float kLastTriScore = 0.75f;
+const float kValenceBoostScale = 2.0f;
+const float kValenceBoostPower = 0.5f;
+
+size_t GetNumVertices(const ObjParser::ParsedData& mesh) {
+  return mesh.positions ? mesh.positions->size() : 0;
+}
+
+// result[i] = array[source[i]].
+template <class T>
+void Gather(std::unique_ptr<std::vector<T>>& array,
+            const std::vector<uint32_t>& source) {
+  if (array == nullptr)
+    return;
+  std::vector<T> result(source.size());
+  for (size_t i = 0; i < source.size(); i++) {
+    result[i] = (*array)[source[i]];
+  }
+  array->swap(result);
+}
+
+void GatherVertices(ObjParser::ParsedData& mesh,
+                    const std::vector<uint32_t>& source) {
+  Gather(mesh.positions, source);
+  Gather(mesh.normals, source);
+  Gather(mesh.tex_coords, source);
+}
+
+// Index offsets at which a triangle range ends: the group boundaries and
+// the end of the index array, sorted.
+std::vector<size_t> GetRangeEnds(const ObjParser::ParsedData& mesh) {
+  size_t num_indices = mesh.indices->size();
+  std::vector<size_t> ends = {num_indices};
+  for (const MeshGroup& group : mesh.groups) {
+    ends.push_back(std::min(group.start_face_index, num_indices));
+    ends.push_back(
+        std::min(group.start_face_index + group.num_indices, num_indices));
+  }
+  std::sort(ends.begin(), ends.end());
+  ends.erase(std::unique(ends.begin(), ends.end()), ends.end());
+  if (ends.front() == 0)
+    ends.erase(ends.begin());
+  return ends;
+}
+
+// Removes triangles with repeated vertices and moves the group ranges
+// accordingly.
+void DropDegenerateTriangles(ObjParser::ParsedData& mesh) {
+  IndexArray& indices = *mesh.indices;
+  size_t num_triangles = indices.size() / 3;
+  // Triangles kept before each triangle.
+  std::vector<size_t> kept_before(num_triangles + 1);
+  size_t kept = 0;
+  for (size_t t = 0; t < num_triangles; t++) {
+    kept_before[t] = kept;
+    unsigned int a = indices[3 * t];
+    unsigned int b = indices[3 * t + 1];
+    unsigned int c = indices[3 * t + 2];
+    if (a == b || b == c || c == a)
+      continue;
+    indices[3 * kept] = a;
+    indices[3 * kept + 1] = b;
+    indices[3 * kept + 2] = c;
+    kept++;
+  }
+  kept_before[num_triangles] = kept;
+  if (kept == num_triangles)
+    return;
+  indices.resize(3 * kept);
+
+  for (MeshGroup& group : mesh.groups) {
+    size_t begin = std::min(group.start_face_index / 3, num_triangles);
+    size_t end = std::min((group.start_face_index + group.num_indices) / 3,
+                          num_triangles);
+    group.start_face_index = 3 * kept_before[begin];
+    group.num_indices = 3 * (kept_before[end] - kept_before[begin]);
+  }
+  mesh.groups.erase(
+      std::remove_if(mesh.groups.begin(), mesh.groups.end(),
+                     [](MeshGroup& g) { return g.num_indices == 0; }),
+      mesh.groups.end());
+}
+
+uint64_t HashCell(int64_t x, int64_t y, int64_t z) {
+  return (uint64_t(x) * 73856093ull) ^ (uint64_t(y) * 19349663ull) ^
+         (uint64_t(z) * 83492791ull);
+}
+
+// Component-wise comparison of float vectors.
+template <class T>
+bool IsClose(const T& a, const T& b, float epsilon) {
+  for (int i = 0; i < int(sizeof(T) / sizeof(float)); i++) {
+    if (std::abs(a[i] - b[i]) > epsilon)
+      return false;
+  }
+  return true;
+}
+
+class VertexScorer {
+ public:
+  VertexScorer() {
+    for (size_t i = 0; i < kMaxCacheSize; i++) {
+      if (i < 3) {
+        // The last triangle's vertices get a fixed score, whatever their
+        // order, so that no triangle is favored for sharing a single one.
+        cache_scores_[i] = kLastTriScore;
+      } else {
+        float scale = 1.f / float(kMaxCacheSize - 3);
+        cache_scores_[i] =
+            std::pow(1.f - float(i - 3) * scale, kCacheDecayPower);
+      }
+    }
+    for (size_t i = 0; i < kNumValenceScores; i++) {
+      valence_scores_[i] =
+          i == 0 ? 0.f
+                 : kValenceBoostScale * std::pow(float(i), -kValenceBoostPower);
+    }
+  }
+
+  // cache_position is -1 for vertices outside of the cache.
+  float GetScore(int cache_position, uint32_t remaining_triangles) const {
+    // Vertices without triangles left do not matter any more.
+    if (remaining_triangles == 0)
+      return -1.f;
+    float score = cache_position < 0 ? 0.f : cache_scores_[cache_position];
+    // Vertices with few triangles left are boosted, so that they are
+    // finished off instead of being left to cost another miss later.
+    if (remaining_triangles < kNumValenceScores) {
+      score += valence_scores_[remaining_triangles];
+    } else {
+      score += kValenceBoostScale *
+               std::pow(float(remaining_triangles), -kValenceBoostPower);
+    }
+    return score;
+  }
+
+ private:
+  static const size_t kNumValenceScores = 32;
+  float cache_scores_[kMaxCacheSize];
+  float valence_scores_[kNumValenceScores];
+};
+
+// Reorders the triangles in [3 * first, 3 * (first + count)) of indices.
+// local_ids has one entry per vertex of the mesh, all kUnused, and is left
+// that way.
+void OptimizeTriangleRange(IndexArray& indices,
+                           size_t first,
+                           size_t count,
+                           std::vector<uint32_t>& local_ids,
+                           const VertexScorer& scorer) {
+  unsigned int* range = indices.data() + 3 * first;
+
+  // Number the vertices of the range from 0.
+  std::vector<uint32_t> global_ids;
+  std::vector<uint32_t> corners(3 * count);
+  for (size_t i = 0; i < 3 * count; i++) {
+    uint32_t& local_id = local_ids[range[i]];
+    if (local_id == kUnused) {
+      local_id = uint32_t(global_ids.size());
+      global_ids.push_back(range[i]);
+    }
+    corners[i] = local_id;
+  }
+  size_t num_vertices = global_ids.size();
+
+  // Triangles of each vertex, with the ones still to be emitted first.
+  std::vector<uint32_t> remaining(num_vertices, 0);
+  for (uint32_t v : corners) {
+    remaining[v]++;
+  }
+  std::vector<uint32_t> adjacency_offsets(num_vertices + 1, 0);
+  for (size_t v = 0; v < num_vertices; v++) {
+    adjacency_offsets[v + 1] = adjacency_offsets[v] + remaining[v];
+  }
+  std::vector<uint32_t> adjacency(3 * count);
+  {
+    std::vector<uint32_t> filled(adjacency_offsets.begin(),
+                                 adjacency_offsets.end() - 1);
+    for (size_t i = 0; i < 3 * count; i++) {
+      adjacency[filled[corners[i]]++] = uint32_t(i / 3);
+    }
+  }
+
+  std::vector<int> cache_positions(num_vertices, -1);
+  std::vector<float> vertex_scores(num_vertices);
+  for (size_t v = 0; v < num_vertices; v++) {
+    vertex_scores[v] = scorer.GetScore(-1, remaining[v]);
+  }
+  std::vector<bool> emitted(count, false);
+  size_t best = 0;
+  float best_score = -1.f;
+  for (size_t t = 0; t < count; t++) {
+    float score = vertex_scores[corners[3 * t]] +
+                  vertex_scores[corners[3 * t + 1]] +
+                  vertex_scores[corners[3 * t + 2]];
+    if (score > best_score) {
+      best_score = score;
+      best = t;
+    }
+  }
+
+  std::vector<uint32_t> cache;
+  std::vector<uint32_t> new_cache;
+  std::vector<uint32_t> order;
+  order.reserve(count);
+  // Next triangle in input order to try when the cache offers none.
+  size_t next_unemitted = 0;
+  while (order.size() < count) {
+    if (best == kUnused) {
+      while (emitted[next_unemitted]) {
+        next_unemitted++;
+      }
+      best = next_unemitted;
+    }
+    emitted[best] = true;
+    order.push_back(uint32_t(best));
+
+    const uint32_t* triangle = &corners[3 * best];
+    for (size_t i = 0; i < 3; i++) {
+      uint32_t v = triangle[i];
+      // Move best past the triangles still to be emitted.
+      uint32_t* begin = &adjacency[adjacency_offsets[v]];
+      uint32_t* last = begin + remaining[v] - 1;
+      *std::find(begin, last + 1, uint32_t(best)) = *last;
+      *last = uint32_t(best);
+      remaining[v]--;
+    }
+
+    // The triangle's vertices move to the front of the LRU cache.
+    new_cache.assign(triangle, triangle + 3);
+    for (uint32_t v : cache) {
+      if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+        new_cache.push_back(v);
+    }
+    for (size_t i = 0; i < new_cache.size(); i++) {
+      uint32_t v = new_cache[i];
+      cache_positions[v] = i < kMaxCacheSize ? int(i) : -1;
+      vertex_scores[v] = scorer.GetScore(cache_positions[v], remaining[v]);
+    }
+
+    // Only triangles of vertices whose score changed can have become the
+    // best; if none is left, the next one is taken in input order.
+    best = kUnused;
+    best_score = -1.f;
+    for (uint32_t v : new_cache) {
+      for (uint32_t j = 0; j < remaining[v]; j++) {
+        uint32_t t = adjacency[adjacency_offsets[v] + j];
+        const uint32_t* c = &corners[3 * t];
+        float score = vertex_scores[c[0]] + vertex_scores[c[1]] +
+                      vertex_scores[c[2]];
+        if (score > best_score) {
+          best_score = score;
+          best = t;
+        }
+      }
+    }
+
+    if (new_cache.size() > kMaxCacheSize)
+      new_cache.resize(kMaxCacheSize);
+    cache.swap(new_cache);
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = 0; j < 3; j++) {
+      range[3 * i + j] = global_ids[corners[3 * order[i] + j]];
+    }
+  }
+  for (uint32_t v : global_ids) {
+    local_ids[v] = kUnused;
+  }
+}
+}  // namespace
+
+MeshOptimizeStats MeshOptimizer::Optimize(ObjParser::ParsedData& mesh) {
+  MeshOptimizeStats stats;
+  size_t num_vertices = GetNumVertices(mesh);
+  if (num_vertices == 0 || mesh.indices == nullptr ||
+      mesh.indices->size() % 3 != 0 ||
+      (mesh.normals && mesh.normals->size() != num_vertices) ||
+      (mesh.tex_coords && mesh.tex_coords->size() != num_vertices)) {
+    // Not an indexed triangle mesh with one value per vertex.
+    return stats;
+  }
+  stats.vertices_before = num_vertices;
+  stats.triangles_before = mesh.indices->size() / 3;
+  stats.acmr_before = ComputeACMR(*mesh.indices);
+
+  WeldVertices(mesh);
+  OptimizeVertexCache(mesh);
+  OptimizeVertexFetch(mesh);
+
+  stats.vertices_after = GetNumVertices(mesh);
+  stats.triangles_after = mesh.indices->size() / 3;
+  stats.acmr_after = ComputeACMR(*mesh.indices);
+  return stats;
+}
+
+size_t MeshOptimizer::WeldVertices(ObjParser::ParsedData& mesh,
+                                   float tolerance) {
+  size_t num_vertices = GetNumVertices(mesh);
+  if (num_vertices == 0 || mesh.indices == nullptr)
+    return num_vertices;
+  const PositionArray& positions = *mesh.positions;
+
+  BoundingBox box = BoundingBox::FromPoints(positions);
+  glm::vec3 size = box.max - box.min;
+  float extent = std::max(size.x, std::max(size.y, size.z));
+  float epsilon = tolerance * extent;
+  // Matches are searched in the 27 cells around a vertex, which covers
+  // epsilon as long as cells are at least that large. The lower bound keeps
+  // cell coordinates small.
+  float cell_size = std::max(epsilon, extent / float(1 << 20));
+  if (cell_size <= 0.f)
+    cell_size = 1.f;
+
+  // Chained hash table of the vertices kept so far, bucketed by cell.
+  size_t table_size = 1;
+  while (table_size < 2 * num_vertices) {
+    table_size *= 2;
+  }
+  std::vector<uint32_t> heads(table_size, kUnused);
+  std::vector<uint32_t> next(num_vertices, kUnused);
+
+  std::vector<uint32_t> remap(num_vertices);
+  std::vector<uint32_t> kept;
+  for (size_t i = 0; i < num_vertices; i++) {
+    const glm::vec3& p = positions[i];
+    int64_t cell[3];
+    for (int k = 0; k < 3; k++) {
+      cell[k] = int64_t(std::floor((p[k] - box.min[k]) / cell_size));
+    }
+
+    uint32_t match = kUnused;
+    for (int dx = -1; dx <= 1 && match == kUnused; dx++) {
+      for (int dy = -1; dy <= 1 && match == kUnused; dy++) {
+        for (int dz = -1; dz <= 1 && match == kUnused; dz++) {
+          uint64_t bucket =
+              HashCell(cell[0] + dx, cell[1] + dy, cell[2] + dz) &
+              (table_size - 1);
+          for (uint32_t j = heads[bucket]; j != kUnused; j = next[j]) {
+            if (IsClose(p, positions[j], epsilon) &&
+                (!mesh.normals ||
+                 IsClose((*mesh.normals)[i], (*mesh.normals)[j], tolerance)) &&
+                (!mesh.tex_coords || IsClose((*mesh.tex_coords)[i],
+                                             (*mesh.tex_coords)[j],
+                                             tolerance))) {
+              match = j;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    if (match != kUnused) {
+      remap[i] = remap[match];
+    } else {
+      remap[i] = uint32_t(kept.size());
+      kept.push_back(uint32_t(i));
+      uint64_t bucket =
+          HashCell(cell[0], cell[1], cell[2]) & (table_size - 1);
+      next[i] = heads[bucket];
+      heads[bucket] = uint32_t(i);
+    }
+  }
+
+  if (kept.size() < num_vertices) {
+    for (unsigned int& index : *mesh.indices) {
+      index = remap[index];
+    }
+    GatherVertices(mesh, kept);
+  }
+  // The source may have degenerate triangles of its own.
+  DropDegenerateTriangles(mesh);
+  return kept.size();
+}
+
+void MeshOptimizer::OptimizeVertexCache(ObjParser::ParsedData& mesh) {
+  if (mesh.indices == nullptr || mesh.indices->empty())
+    return;
+  VertexScorer scorer;
+  std::vector<uint32_t> local_ids(GetNumVertices(mesh), kUnused);
+  size_t begin = 0;
+  for (size_t end : GetRangeEnds(mesh)) {
+    OptimizeTriangleRange(*mesh.indices, begin / 3, (end - begin) / 3,
+                          local_ids, scorer);
+    begin = end;
+  }
+}
+
+void MeshOptimizer::OptimizeVertexFetch(ObjParser::ParsedData& mesh) {
+  if (mesh.indices == nullptr)
+    return;
+  std::vector<uint32_t> remap(GetNumVertices(mesh), kUnused);
+  std::vector<uint32_t> order;
+  for (unsigned int& index : *mesh.indices) {
+    if (remap[index] == kUnused) {
+      remap[index] = uint32_t(order.size());
+      order.push_back(index);
+    }
+    index = remap[index];
+  }
+  GatherVertices(mesh, order);
+}
+
+float MeshOptimizer::ComputeACMR(const IndexArray& indices,
+                                 size_t cache_size) {
+  if (indices.size() < 3)
+    return 0.f;
+  // FIFO cache, as used by most hardware.
+  std::vector<unsigned int> cache(cache_size, kUnused);
+  size_t next_slot = 0;
+  size_t misses = 0;
+  for (unsigned int index : indices) {
+    if (std::find(cache.begin(), cache.end(), index) == cache.end()) {
+      cache[next_slot] = index;
+      next_slot = (next_slot + 1) % cache_size;
+      misses++;
+    }
+  }
+  return float(misses) / float(indices.size() / 3);
+}
+}  // namespace GLOO
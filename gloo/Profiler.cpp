@@ -0,0 +1,248 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "external.hpp"
+#include "utils.hpp"
+
+namespace GLOO {
+Profiler::Profiler()
+    : epoch_(std::chrono::steady_clock::now()),
+      owner_(std::this_thread::get_id()) {
+  frame_series_ = GetSeries("Frame", false);
+}
+
+double Profiler::NowUs() const {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - epoch_)
+      .count();
+}
+
+void Profiler::CheckThread() const {
+  if (std::this_thread::get_id() != owner_) {
+    throw std::runtime_error(
+        "Profiler scopes must be used on the thread running the frames!");
+  }
+}
+
+size_t Profiler::GetSeries(const std::string& name, bool gpu) {
+  auto& index = series_index_[gpu ? 1 : 0];
+  auto itr = index.find(name);
+  if (itr != index.end())
+    return itr->second;
+  Series series;
+  series.name = name;
+  series.gpu = gpu;
+  series.history.assign(kHistorySize, 0.f);
+  series.next = 0;
+  series.frame_total_ms = 0.f;
+  series_.push_back(series);
+  index[name] = series_.size() - 1;
+  return series_.size() - 1;
+}
+
+void Profiler::BeginFrame() {
+  owner_ = std::this_thread::get_id();
+  frame_start_us_ = NowUs();
+  ResolveGpuQueries();
+}
+
+void Profiler::EndFrame() {
+  if (!cpu_stack_.empty() || gpu_scope_open_) {
+    throw std::runtime_error(
+        "Profiler scopes left open at the end of a frame!");
+  }
+  double end_us = NowUs();
+  Record(frame_series_, frame_start_us_, end_us - frame_start_us_);
+  series_[frame_series_].frame_total_ms =
+      float((end_us - frame_start_us_) / 1000.0);
+  PushFrameTotals(false);
+
+  pending_frames_.push_back(std::move(frame_queries_));
+  frame_queries_.clear();
+}
+
+void Profiler::BeginCpuScope(const std::string& name) {
+  CheckThread();
+  cpu_stack_.push_back({GetSeries(name, false), NowUs()});
+}
+
+void Profiler::EndCpuScope() {
+  CheckThread();
+  if (cpu_stack_.empty()) {
+    throw std::runtime_error("No CPU profiler scope to end!");
+  }
+  CpuScope scope = cpu_stack_.back();
+  cpu_stack_.pop_back();
+  double duration_us = NowUs() - scope.start_us;
+  series_[scope.series].frame_total_ms += float(duration_us / 1000.0);
+  Record(scope.series, scope.start_us, duration_us);
+}
+
+void Profiler::BeginGpuScope(const std::string& name) {
+  CheckThread();
+  if (gpu_scope_open_) {
+    throw std::runtime_error("GPU profiler scopes cannot nest!");
+  }
+  GpuQuery query;
+  if (free_queries_.empty()) {
+    GL_CHECK(glGenQueries(1, &query.handle));
+  } else {
+    query.handle = free_queries_.back();
+    free_queries_.pop_back();
+  }
+  query.series = GetSeries(name, true);
+  query.start_us = NowUs();
+  GL_CHECK(glBeginQuery(GL_TIME_ELAPSED, query.handle));
+  frame_queries_.push_back(query);
+  gpu_scope_open_ = true;
+}
+
+void Profiler::EndGpuScope() {
+  CheckThread();
+  if (!gpu_scope_open_) {
+    throw std::runtime_error("No GPU profiler scope to end!");
+  }
+  GL_CHECK(glEndQuery(GL_TIME_ELAPSED));
+  gpu_scope_open_ = false;
+}
+
+void Profiler::ResolveGpuQueries() {
+  while (!pending_frames_.empty()) {
+    std::vector<GpuQuery>& queries = pending_frames_.front();
+    if (!queries.empty() && pending_frames_.size() <= kMaxPendingFrames) {
+      // Queries finish in order, so the last one stands for the frame.
+      GLint available = 0;
+      GL_CHECK(glGetQueryObjectiv(queries.back().handle,
+                                  GL_QUERY_RESULT_AVAILABLE, &available));
+      if (!available)
+        return;
+    }
+    for (const GpuQuery& query : queries) {
+      GLuint64 elapsed_ns = 0;
+      GL_CHECK(
+          glGetQueryObjectui64v(query.handle, GL_QUERY_RESULT, &elapsed_ns));
+      series_[query.series].frame_total_ms += float(elapsed_ns / 1e6);
+      Record(query.series, query.start_us, elapsed_ns / 1e3);
+      free_queries_.push_back(query.handle);
+    }
+    PushFrameTotals(true);
+    pending_frames_.pop_front();
+  }
+}
+
+void Profiler::PushFrameTotals(bool gpu) {
+  for (Series& series : series_) {
+    if (series.gpu != gpu)
+      continue;
+    series.history[series.next] = series.frame_total_ms;
+    series.next = (series.next + 1) % kHistorySize;
+    series.frame_total_ms = 0.f;
+  }
+}
+
+void Profiler::Record(size_t series, double start_us, double duration_us) {
+  if (!recording_)
+    return;
+  if (trace_events_.size() >= kMaxTraceEvents) {
+    recording_ = false;
+    return;
+  }
+  trace_events_.push_back({series, start_us, duration_us});
+}
+
+void Profiler::ReleaseGpuQueries() {
+  for (auto& queries : pending_frames_) {
+    for (const GpuQuery& query : queries) {
+      free_queries_.push_back(query.handle);
+    }
+  }
+  for (const GpuQuery& query : frame_queries_) {
+    free_queries_.push_back(query.handle);
+  }
+  pending_frames_.clear();
+  frame_queries_.clear();
+  if (!free_queries_.empty()) {
+    GL_CHECK(glDeleteQueries(GLsizei(free_queries_.size()),
+                             free_queries_.data()));
+  }
+  free_queries_.clear();
+}
+
+void Profiler::DrawGUI() {
+  ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+  for (const Series& series : series_) {
+    // The latest entry is the one before next.
+    float latest = series.history[(series.next + kHistorySize - 1) %
+                                  kHistorySize];
+    float peak =
+        *std::max_element(series.history.begin(), series.history.end());
+    std::string label =
+        (series.gpu ? "GPU " : "CPU ") + series.name + "##" + series.name;
+    char overlay[32];
+    snprintf(overlay, sizeof(overlay), "%.2f ms", latest);
+    ImGui::PlotLines(label.c_str(), series.history.data(), int(kHistorySize),
+                     int(series.next), overlay, 0.f,
+                     std::max(peak, 0.1f), ImVec2(240.f, 40.f));
+  }
+
+  bool recording = recording_;
+  if (ImGui::Checkbox("Record trace", &recording)) {
+    recording_ = recording;
+  }
+  ImGui::Text("%zu scopes recorded", trace_events_.size());
+  if (ImGui::Button("Save trace.json")) {
+    try {
+      WriteChromeTrace("trace.json");
+      trace_status_ = "Saved " + std::to_string(trace_events_.size()) +
+                      " scopes to trace.json";
+    } catch (const std::exception& e) {
+      trace_status_ = e.what();
+    }
+  }
+  if (!trace_status_.empty()) {
+    ImGui::Text("%s", trace_status_.c_str());
+  }
+  if (ImGui::Button("Clear trace")) {
+    ClearTrace();
+  }
+  ImGui::End();
+}
+
+static std::string EscapeJson(const std::string& s) {
+  std::string result;
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result;
+}
+
+void Profiler::WriteChromeTrace(const std::string& filename) const {
+  std::ofstream file(filename);
+  if (!file) {
+    throw std::runtime_error("Cannot write trace to " + filename + "!");
+  }
+  // Timestamps and durations are in microseconds. Thread 1 holds the CPU
+  // scopes and thread 2 the GPU scopes.
+  file << std::fixed << std::setprecision(3);
+  file << "{\"traceEvents\":[\n";
+  file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+          "\"args\":{\"name\":\"CPU\"}},\n";
+  file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+          "\"args\":{\"name\":\"GPU\"}}";
+  for (const TraceEvent& event : trace_events_) {
+    const Series& series = series_[event.series];
+    file << ",\n{\"name\":\"" << EscapeJson(series.name) << "\",\"cat\":\""
+         << (series.gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"ts\":"
+         << event.start_us << ",\"dur\":" << event.duration_us
+         << ",\"pid\":1,\"tid\":" << (series.gpu ? 2 : 1) << "}";
+  }
+  file << "\n]}\n";
+}
+}  // namespace GLOO
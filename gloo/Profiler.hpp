@@ -0,0 +1,160 @@
+#ifndef GLOO_PROFILER_H_
+#define GLOO_PROFILER_H_
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace GLOO {
+// Frame profiler. CPU scopes are timed with a steady clock and may nest;
+// GPU scopes are timed with GL_TIME_ELAPSED queries, which GL does not allow
+// to nest, and are read back a few frames later so that the CPU never waits
+// on them. Times are summed per scope name over a frame and kept as a rolling
+// history shown by DrawGUI. Individual scopes can also be recorded and
+// written out as a Chrome trace. Only for use on the thread owning the GL
+// context: that is the thread running BeginFrame (or, before the first
+// frame, the one that created the profiler), and opening or closing a
+// scope on any other thread throws.
+class Profiler {
+ public:
+  // Singleton design pattern.
+  // Profiler is initialized the first time GetInstance is called.
+  static Profiler& GetInstance() {
+    static Profiler _instance;
+    return _instance;
+  }
+
+  Profiler(const Profiler&) = delete;
+  void operator=(const Profiler&) = delete;
+
+  void BeginFrame();
+  void EndFrame();
+
+  void BeginCpuScope(const std::string& name);
+  void EndCpuScope();
+  void BeginGpuScope(const std::string& name);
+  void EndGpuScope();
+
+  // Shows the rolling graphs and the trace recording controls.
+  void DrawGUI();
+
+  void SetRecording(bool recording) {
+    recording_ = recording;
+  }
+  bool IsRecording() const {
+    return recording_;
+  }
+  void ClearTrace() {
+    trace_events_.clear();
+  }
+  // Writes the recorded scopes in the Chrome trace event format, which
+  // chrome://tracing and Perfetto can open. GPU scopes are placed at the
+  // time their commands were issued, on a track of their own. Throws if the
+  // file cannot be written.
+  void WriteChromeTrace(const std::string& filename) const;
+
+  // Deletes the GL query objects; must be called while the GL context still
+  // exists.
+  void ReleaseGpuQueries();
+
+ private:
+  // Number of frames kept for the graphs.
+  static const size_t kHistorySize = 240;
+  // Frames whose GPU queries may be in flight before reading them back
+  // blocks.
+  static const size_t kMaxPendingFrames = 4;
+  // Recording stops once this many scopes are stored.
+  static const size_t kMaxTraceEvents = 1 << 20;
+
+  struct Series {
+    std::string name;
+    bool gpu;
+    // Ring buffer of per-frame totals in milliseconds; next is the oldest.
+    std::vector<float> history;
+    size_t next;
+    float frame_total_ms;
+  };
+
+  struct CpuScope {
+    size_t series;
+    double start_us;
+  };
+
+  struct GpuQuery {
+    GLuint handle;
+    size_t series;
+    double start_us;
+  };
+
+  struct TraceEvent {
+    size_t series;
+    double start_us;
+    double duration_us;
+  };
+
+  Profiler();
+  ~Profiler() {
+  }
+
+  double NowUs() const;
+  void CheckThread() const;
+  size_t GetSeries(const std::string& name, bool gpu);
+  void PushFrameTotals(bool gpu);
+  // Reads back the oldest frames of GPU queries, waiting for them only if
+  // more than kMaxPendingFrames are in flight.
+  void ResolveGpuQueries();
+  void Record(size_t series, double start_us, double duration_us);
+
+  std::chrono::steady_clock::time_point epoch_;
+  std::thread::id owner_;
+  std::vector<Series> series_;
+  std::unordered_map<std::string, size_t> series_index_[2];
+
+  size_t frame_series_;
+  double frame_start_us_{0};
+  std::vector<CpuScope> cpu_stack_;
+
+  bool gpu_scope_open_{false};
+  std::vector<GpuQuery> frame_queries_;
+  std::deque<std::vector<GpuQuery>> pending_frames_;
+  std::vector<GLuint> free_queries_;
+
+  bool recording_{false};
+  std::vector<TraceEvent> trace_events_;
+  // Outcome of the last save from the GUI.
+  std::string trace_status_;
+};
+
+class ScopedCpuTimer {
+ public:
+  explicit ScopedCpuTimer(const std::string& name) {
+    Profiler::GetInstance().BeginCpuScope(name);
+  }
+  ~ScopedCpuTimer() {
+    Profiler::GetInstance().EndCpuScope();
+  }
+
+  ScopedCpuTimer(const ScopedCpuTimer&) = delete;
+  void operator=(const ScopedCpuTimer&) = delete;
+};
+
+class ScopedGpuTimer {
+ public:
+  explicit ScopedGpuTimer(const std::string& name) {
+    Profiler::GetInstance().BeginGpuScope(name);
+  }
+  ~ScopedGpuTimer() {
+    Profiler::GetInstance().EndGpuScope();
+  }
+
+  ScopedGpuTimer(const ScopedGpuTimer&) = delete;
+  void operator=(const ScopedGpuTimer&) = delete;
+};
+}  // namespace GLOO
+
+#endif
@@ -0,0 +1,105 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+
+namespace GLOO {
+void RenderQueue::Clear() {
+  items_.clear();
+}
+
+void RenderQueue::Push(uint8_t pass,
+                       RenderingComponent* rendering,
+                       ShaderProgram* shader,
+                       const Material* material,
+                       const glm::mat4& model_matrix) {
+  uint32_t material_id = 0;
+  if (material != nullptr) {
+    auto found = material_ids_.find(material);
+    if (found == material_ids_.end()) {
+      // Only 16 bits of the ID make it into the key; start over rather
+      // than let the table grow without bound as materials come and go.
+      if (material_ids_.size() >= 0xffff)
+        material_ids_.clear();
+      found = material_ids_
+                  .emplace(material, uint32_t(material_ids_.size() + 1))
+                  .first;
+    }
+    material_id = found->second;
+  }
+  uint64_t program_id = shader->GetHandle();
+  uint64_t vao_id =
+      rendering->GetVertexObjectPtr()->GetVertexArray().GetHandle();
+  uint64_t key = (uint64_t(pass) << 56) | ((program_id & 0xffff) << 40) |
+                 ((uint64_t(material_id) & 0xffff) << 24) |
+                 (vao_id & 0xffffff);
+  items_.push_back({key, rendering, shader, material, model_matrix});
+}
+
+void RenderQueue::Sort() {
+  std::sort(items_.begin(), items_.end(),
+            [](const RenderItem& a, const RenderItem& b) {
+              return a.key < b.key;
+            });
+}
+
+void RenderStateTracker::Reset() {
+  shader_ = nullptr;
+  vertex_array_ = nullptr;
+  for (auto& program : programs_) {
+    program.second.has_material = false;
+    program.second.has_light_index = false;
+  }
+}
+
+void RenderStateTracker::Finish() {
+  if (shader_ != nullptr)
+    shader_->Unbind();
+  if (vertex_array_ != nullptr)
+    vertex_array_->Unbind();
+  shader_ = nullptr;
+  vertex_array_ = nullptr;
+}
+
+void RenderStateTracker::UseProgram(const ShaderProgram* shader) {
+  if (shader == shader_) {
+    stats_.program_binds_skipped++;
+    return;
+  }
+  shader->Bind();
+  shader_ = shader;
+  stats_.program_binds++;
+}
+
+void RenderStateTracker::BindVertexArray(const VertexArray* vertex_array) {
+  if (vertex_array == vertex_array_) {
+    stats_.vertex_array_binds_skipped++;
+    return;
+  }
+  vertex_array->Bind();
+  vertex_array_ = vertex_array;
+  stats_.vertex_array_binds++;
+}
+
+void RenderStateTracker::SetMaterial(const ShaderProgram* shader,
+                                     const Material* material) {
+  ProgramState& state = programs_[shader];
+  if (state.has_material && state.material == material) {
+    stats_.material_uploads_skipped++;
+    return;
+  }
+  shader->SetMaterial(material);
+  state.material = material;
+  state.has_material = true;
+  stats_.material_uploads++;
+}
+
+void RenderStateTracker::SetLightIndex(const ShaderProgram* shader,
+                                       int light_index) {
+  ProgramState& state = programs_[shader];
+  if (state.has_light_index && state.light_index == light_index)
+    return;
+  shader->SetLightIndex(light_index);
+  state.light_index = light_index;
+  state.has_light_index = true;
+}
+}  // namespace GLOO
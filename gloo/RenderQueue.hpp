@@ -0,0 +1,102 @@
+#ifndef GLOO_RENDER_QUEUE_H_
+#define GLOO_RENDER_QUEUE_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Material.hpp"
+#include "components/RenderingComponent.hpp"
+#include "shaders/ShaderProgram.hpp"
+
+namespace GLOO {
+struct RenderItem {
+  uint64_t key;
+  RenderingComponent* rendering;
+  ShaderProgram* shader;
+  // nullptr if the node has no material.
+  const Material* material;
+  glm::mat4 model_matrix;
+};
+
+// Draws of one frame, sorted so that draws sharing a pass, program,
+// material and VAO are adjacent. The key packs, from the most significant
+// bits down:
+//   pass (8 bits) | program (16 bits) | material (16 bits) | VAO (24 bits)
+// Programs and VAOs are keyed by their GL names, materials by the order in
+// which the queue first saw them. Material IDs are kept across frames, so
+// a steady scene only looks them up.
+class RenderQueue {
+ public:
+  void Clear();
+  void Push(uint8_t pass,
+            RenderingComponent* rendering,
+            ShaderProgram* shader,
+            const Material* material,
+            const glm::mat4& model_matrix);
+  void Sort();
+
+  const std::vector<RenderItem>& GetItems() const {
+    return items_;
+  }
+
+  static uint8_t GetPass(uint64_t key) {
+    return uint8_t(key >> 56);
+  }
+
+ private:
+  std::vector<RenderItem> items_;
+  std::unordered_map<const Material*, uint32_t> material_ids_;
+};
+
+struct RenderStats {
+  // Active rendering components inside and outside the view frustum.
+  size_t objects_drawn = 0;
+  size_t objects_culled = 0;
+  size_t draw_calls = 0;
+  size_t program_binds = 0;
+  size_t program_binds_skipped = 0;
+  size_t vertex_array_binds = 0;
+  size_t vertex_array_binds_skipped = 0;
+  size_t material_uploads = 0;
+  size_t material_uploads_skipped = 0;
+};
+
+// Forwards state changes to GL only when they differ from the current
+// state. Uniforms live in the program, so the material and light index last
+// uploaded are remembered per program.
+class RenderStateTracker {
+ public:
+  explicit RenderStateTracker(RenderStats& stats) : stats_(stats) {
+  }
+
+  // Forgets all state, so that everything is set again. Called at the
+  // start of a frame: other code may have changed bindings or uniforms
+  // in between.
+  void Reset();
+  // Unbinds the program and the VAO.
+  void Finish();
+
+  void UseProgram(const ShaderProgram* shader);
+  void BindVertexArray(const VertexArray* vertex_array);
+  void SetMaterial(const ShaderProgram* shader, const Material* material);
+  void SetLightIndex(const ShaderProgram* shader, int light_index);
+
+ private:
+  struct ProgramState {
+    const Material* material;
+    int light_index;
+    bool has_material;
+    bool has_light_index;
+  };
+
+  RenderStats& stats_;
+  const ShaderProgram* shader_{nullptr};
+  const VertexArray* vertex_array_{nullptr};
+  std::unordered_map<const ShaderProgram*, ProgramState> programs_;
+};
+}  // namespace GLOO
+
+#endif
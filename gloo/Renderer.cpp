@@ -1,20 +1,26 @@
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <stdexcept>
 #include <glad/glad.h>
 #include <glm/gtx/string_cast.hpp>
 
 #include "Application.hpp"
+#include "Profiler.hpp"
 #include "Scene.hpp"
 #include "utils.hpp"
 #include "gl_wrapper/BindGuard.hpp"
 #include "shaders/ShaderProgram.hpp"
-#include "components/ShadingComponent.hpp"
 #include "components/CameraComponent.hpp"
 #include "debug/PrimitiveFactory.hpp"
+#include "lights/AmbientLight.hpp"
+#include "lights/DirectionalLight.hpp"
+#include "lights/PointLight.hpp"
 
 namespace GLOO {
-Renderer::Renderer(Application& application) : application_(application) {
+Renderer::Renderer(Application& application)
+    : application_(application), render_state_(stats_) {
   UNUSED(application_);
 }
 
@@ -30,41 +36,77 @@ void Renderer::SetRenderingOptions() const {
   GL_CHECK(glBlendFunc(GL_ONE, GL_ONE));
 }
 
+void Renderer::UploadUniformBlocks(
+    const CameraComponent& camera,
+    const std::vector<LightComponent*>& lights) const {
+  CameraBlock camera_data;
+  camera_data.view_matrix = camera.GetViewMatrix();
+  camera_data.projection_matrix = camera.GetProjectionMatrix();
+  camera_data.camera_position = glm::vec3(
+      glm::inverse(camera.GetViewMatrix()) * glm::vec4(0.f, 0.f, 0.f, 1.f));
+  camera_block_.Update(camera_data);
+  camera_block_.BindBase(kCameraBlockBinding);
+
+  LightBlock light_data = {};
+  light_data.num_lights = std::min(int(lights.size()), kMaxLights);
+  for (int i = 0; i < light_data.num_lights; i++) {
+    auto light_ptr = lights[i]->GetLightPtr();
+    if (light_ptr == nullptr) {
+      throw std::runtime_error("Light component has no light attached!");
+    }
+    LightBlockEntry& entry = light_data.lights[i];
+    entry.type = int(light_ptr->GetType());
+    entry.diffuse = light_ptr->GetDiffuseColor();
+    entry.specular = light_ptr->GetSpecularColor();
+    if (light_ptr->GetType() == LightType::Ambient) {
+      entry.ambient = static_cast<AmbientLight*>(light_ptr)->GetAmbientColor();
+    } else if (light_ptr->GetType() == LightType::Point) {
+      entry.position = lights[i]->GetNodePtr()->GetTransform().GetPosition();
+      entry.attenuation = static_cast<PointLight*>(light_ptr)->GetAttenuation();
+    } else if (light_ptr->GetType() == LightType::Directional) {
+      entry.direction =
+          static_cast<DirectionalLight*>(light_ptr)->GetDirection();
+    } else {
+      throw std::runtime_error(
+          "Encountered light type unrecognized by the shader!");
+    }
+  }
+  light_block_.Update(light_data);
+  light_block_.BindBase(kLightBlockBinding);
+}
+
 void Renderer::Render(const Scene& scene) const {
   SetRenderingOptions();
   RenderScene(scene);
 }
 
-void Renderer::RecursiveRetrieve(const SceneNode& node,
-                                 RenderingInfo& info,
-                                 const glm::mat4& model_matrix) {
-  // model_matrix is parent to world transformation.
-  glm::mat4 new_matrix =
-      model_matrix * node.GetTransform().GetLocalToParentMatrix();
-  auto robj_ptr = node.GetComponentPtr<RenderingComponent>();
-  if (robj_ptr != nullptr && node.IsActive())
-    info.emplace_back(robj_ptr, new_matrix);
-
-  size_t child_count = node.GetChildrenCount();
-  for (size_t i = 0; i < child_count; i++) {
-    RecursiveRetrieve(node.GetChild(i), info, new_matrix);
-  }
-}
-
 Renderer::RenderingInfo Renderer::RetrieveRenderingInfo(
-    const Scene& scene) const {
+    const Scene& scene,
+    const Frustum& frustum) const {
   RenderingInfo info;
-  const SceneNode& root = scene.GetRootNode();
-  // Efficient implementation without redundant matrix multiplications.
-  RecursiveRetrieve(root, info, glm::mat4(1.0f));
+  // Visit the render records of the scene's registry rather than walking
+  // the tree; only the world matrices of moved nodes are recomputed.
+  const ComponentRegistry& registry = scene.GetRegistry();
+  registry.UpdateWorldMatrices();
+  for (const RenderRecord& record : registry.GetRenderRecords()) {
+    if (!record.active)
+      continue;
+    const BoundingBox& bounds =
+        record.rendering->GetVertexObjectPtr()->GetBoundingBox();
+    if (frustum.Intersects(bounds.Transformed(*record.world_matrix)))
+      info.push_back(&record);
+    else
+      stats_.objects_culled++;
+  }
+  stats_.objects_drawn = info.size();
   return info;
 }
 
 void Renderer::RenderScene(const Scene& scene) const {
   GL_CHECK(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+  stats_ = RenderStats();
 
   const SceneNode& root = scene.GetRootNode();
-  auto rendering_info = RetrieveRenderingInfo(scene);
   auto light_ptrs = root.GetComponentPtrsInChildren<LightComponent>();
   if (light_ptrs.size() == 0) {
     // Make sure there are at least 2 passes of we don't forget to set color
@@ -72,74 +114,109 @@ void Renderer::RenderScene(const Scene& scene) const {
     return;
   }
 
+  Profiler& profiler = Profiler::GetInstance();
+  profiler.BeginCpuScope("Build render queue");
   CameraComponent* camera = scene.GetActiveCameraPtr();
+  Frustum frustum(camera->GetProjectionMatrix() * camera->GetViewMatrix());
+  auto rendering_info = RetrieveRenderingInfo(scene, frustum);
+  UploadUniformBlocks(*camera, light_ptrs);
+  size_t num_lights = std::min(light_ptrs.size(), size_t(kMaxLights));
+
+  // Single-pass lighting has one pass. Multi-pass lighting has a depth
+  // pre-pass (pass 0) followed by one pass per light.
+  size_t num_passes =
+      lighting_mode_ == LightingMode::SinglePass ? 1 : num_lights + 1;
+  render_queue_.Clear();
+  for (const RenderRecord* record : rendering_info) {
+    if (record->shader == nullptr) {
+      std::cerr << "Some mesh is not attached with a shader during rendering!"
+                << std::endl;
+      continue;
+    }
+    for (size_t pass = 0; pass < num_passes; pass++) {
+      render_queue_.Push(uint8_t(pass), record->rendering, record->shader,
+                         record->material, *record->world_matrix);
+    }
+  }
+  render_queue_.Sort();
+  profiler.EndCpuScope();
+
+  render_state_.Reset();
+  int current_pass = -1;
+  int light_index = 0;
+  for (const RenderItem& item : render_queue_.GetItems()) {
+    int pass = RenderQueue::GetPass(item.key);
+    if (pass != current_pass) {
+      if (current_pass >= 0) {
+        profiler.EndGpuScope();
+        profiler.EndCpuScope();
+      }
+      current_pass = pass;
+      profiler.BeginCpuScope(GetPassName(pass));
+      profiler.BeginGpuScope(GetPassName(pass));
+      light_index = BeginPass(pass);
+    }
+    render_state_.UseProgram(item.shader);
+    // Set various uniform variables in the shaders.
+    item.shader->SetTargetNode(*item.rendering->GetNodePtr(),
+                               item.model_matrix);
+    render_state_.SetMaterial(item.shader, item.material);
+    render_state_.SetLightIndex(item.shader, light_index);
+    render_state_.BindVertexArray(
+        &item.rendering->GetVertexObjectPtr()->GetVertexArray());
+
+    item.rendering->Draw();
+    stats_.draw_calls++;
+  }
+  if (current_pass >= 0) {
+    profiler.EndGpuScope();
+    profiler.EndCpuScope();
+  }
+  render_state_.Finish();
+
+  // Restore the defaults set by SetRenderingOptions.
+  GL_CHECK(glDepthMask(GL_TRUE));
+  GL_CHECK(glEnable(GL_BLEND));
+}
+
+const char* Renderer::GetPassName(int pass) const {
+  if (lighting_mode_ == LightingMode::SinglePass)
+    return "Lighting pass";
+  // All light passes share one name, so the profiler sums them.
+  return pass == 0 ? "Depth pre-pass" : "Light passes";
+}
+
+int Renderer::BeginPass(int pass) const {
+  if (lighting_mode_ == LightingMode::SinglePass) {
+    // Every object is drawn once and its shader sums over all lights, so
+    // there is nothing to accumulate: plain depth-tested drawing suffices.
+    GL_CHECK(glDisable(GL_BLEND));
+    GL_CHECK(glDepthMask(GL_TRUE));
+    bool color_mask = GL_TRUE;
+    GL_CHECK(glColorMask(color_mask, color_mask, color_mask, color_mask));
+    return kAllLights;
+  }
 
-  {
+  if (pass == 0) {
     // Here we first do a depth pass (note that this has nothing to do with the
     // shadow map). The goal of this depth pass is to exclude pixels that are
     // not really visible from the camera, in later rendering passes. You can
     // safely leave this pass here without understanding/modifying it, for
     // assignment 5. If you are interested in learning more, see
     // https://www.khronos.org/opengl/wiki/Early_Fragment_Test#Optimization
-
+    GL_CHECK(glEnable(GL_BLEND));
     GL_CHECK(glDepthMask(GL_TRUE));
     bool color_mask = GL_FALSE;
     GL_CHECK(glColorMask(color_mask, color_mask, color_mask, color_mask));
-
-    for (const auto& pr : rendering_info) {
-      auto robj_ptr = pr.first;
-      SceneNode& node = *robj_ptr->GetNodePtr();
-      auto shading_ptr = node.GetComponentPtr<ShadingComponent>();
-      if (shading_ptr == nullptr) {
-        std::cerr << "Some mesh is not attached with a shader during rendering!"
-                  << std::endl;
-        continue;
-      }
-      ShaderProgram* shader = shading_ptr->GetShaderPtr();
-
-      BindGuard shader_bg(shader);
-
-      // Set various uniform variables in the shaders.
-      shader->SetTargetNode(node, pr.second);
-      shader->SetCamera(*camera);
-
-      robj_ptr->Render();
-    }
-  }
-
-  // The real shadow map/Phong shading passes.
-  for (size_t light_id = 0; light_id < light_ptrs.size(); light_id++) {
-
-    GL_CHECK(glDepthMask(GL_FALSE));
-    bool color_mask = GL_TRUE;
-    GL_CHECK(glColorMask(color_mask, color_mask, color_mask, color_mask));
-
-    for (const auto& pr : rendering_info) {
-      auto robj_ptr = pr.first;
-      SceneNode& node = *robj_ptr->GetNodePtr();
-      auto shading_ptr = node.GetComponentPtr<ShadingComponent>();
-      if (shading_ptr == nullptr) {
-        std::cerr << "Some mesh is not attached with a shader during rendering!"
-                  << std::endl;
-        continue;
-      }
-      ShaderProgram* shader = shading_ptr->GetShaderPtr();
-
-      BindGuard shader_bg(shader);
-
-      // Set various uniform variables in the shaders.
-      shader->SetTargetNode(node, pr.second);
-      shader->SetCamera(*camera);
-
-      LightComponent& light = *light_ptrs.at(light_id);
-      shader->SetLightSource(light);
-
-      robj_ptr->Render();
-    }
+    // Colors are masked off; shading with a single light keeps it cheap.
+    return 0;
   }
 
-  // Re-enable writing to depth buffer.
-  GL_CHECK(glDepthMask(GL_TRUE));
+  // The real shadow map/Phong shading passes, one per light.
+  GL_CHECK(glDepthMask(GL_FALSE));
+  bool color_mask = GL_TRUE;
+  GL_CHECK(glColorMask(color_mask, color_mask, color_mask, color_mask));
+  return pass - 1;
 }
 
 }  // namespace GLOO
@@ -1,8 +1,13 @@
 #ifndef GLOO_RENDERER_H_
 #define GLOO_RENDERER_H_
 
+#include "components/CameraComponent.hpp"
 #include "components/LightComponent.hpp"
 #include "components/RenderingComponent.hpp"
+#include "Frustum.hpp"
+#include "gl_wrapper/UniformBuffer.hpp"
+#include "RenderQueue.hpp"
+#include "shaders/UniformBlocks.hpp"
 
 #include <unordered_map>
 
@@ -10,23 +15,59 @@
 namespace GLOO {
 class Scene;
 class Application;
+
+enum class LightingMode {
+  // A depth pre-pass, then one additive pass over all objects per light.
+  MultiPass,
+  // One pass in which shaders loop over all lights. Drawn with blending
+  // off: the shader sums what the additive passes of MultiPass would.
+  SinglePass,
+};
+
 class Renderer {
  public:
   Renderer(Application& application);
   void Render(const Scene& scene) const;
 
+  void SetLightingMode(LightingMode mode) {
+    lighting_mode_ = mode;
+  }
+  LightingMode GetLightingMode() const {
+    return lighting_mode_;
+  }
+  // Counters for the last rendered frame.
+  const RenderStats& GetStats() const {
+    return stats_;
+  }
+
  private:
-  using RenderingInfo = std::vector<std::pair<RenderingComponent*, glm::mat4>>;
+  using RenderingInfo = std::vector<const RenderRecord*>;
   void RenderScene(const Scene& scene) const;
+  // Sets up the GL state of a pass of the current lighting mode and
+  // returns the light index its draws shade with.
+  int BeginPass(int pass) const;
+  // Name under which the profiler times a pass.
+  const char* GetPassName(int pass) const;
   void SetRenderingOptions() const;
+  // Fills the per-frame uniform blocks and binds them for all shaders.
+  void UploadUniformBlocks(const CameraComponent& camera,
+                           const std::vector<LightComponent*>& lights) const;
 
-  RenderingInfo RetrieveRenderingInfo(const Scene& scene) const;
-  static void RecursiveRetrieve(const SceneNode& node,
-                                RenderingInfo& info,
-                                const glm::mat4& model_matrix);
+  // Collects the render records of active nodes whose world-space bounds
+  // intersect frustum.
+  RenderingInfo RetrieveRenderingInfo(const Scene& scene,
+                                      const Frustum& frustum) const;
 
 
   Application& application_;
+  UniformBuffer<CameraBlock> camera_block_;
+  UniformBuffer<LightBlock> light_block_;
+  LightingMode lighting_mode_{LightingMode::SinglePass};
+  // Reused across frames to avoid reallocating.
+  mutable RenderQueue render_queue_;
+  mutable RenderStats stats_;
+  // Keeps its per-program map across frames; reset at the start of each.
+  mutable RenderStateTracker render_state_;
 };
 }  // namespace GLOO
 
@@ -13,6 +13,7 @@ class Scene {
  public:
   Scene(std::unique_ptr<SceneNode> root_node)
       : root_node_(std::move(root_node)), active_camera_ptr_(nullptr) {
+    root_node_->SetRegistry(&registry_);
   }
   SceneNode& GetRootNode() {
     return *root_node_;
@@ -26,11 +27,17 @@ class Scene {
   CameraComponent* GetActiveCameraPtr() const {
     return active_camera_ptr_;
   }
+  // Components attached to nodes in this scene, by type.
+  const ComponentRegistry& GetRegistry() const {
+    return registry_;
+  }
   void Update(double delta_time);
 
  private:
   void RecursiveUpdate(SceneNode& node, double delta_time);
 
+  // Declared before root_node_ so that it outlives the nodes.
+  ComponentRegistry registry_;
   std::unique_ptr<SceneNode> root_node_;
   CameraComponent* active_camera_ptr_;
 };
@@ -2,20 +2,88 @@
 
 #include <glm/gtx/string_cast.hpp>
 
+#include "components/MaterialComponent.hpp"
+#include "components/RenderingComponent.hpp"
+#include "components/ShadingComponent.hpp"
+
 namespace GLOO {
-SceneNode::SceneNode() : transform_(*this), parent_(nullptr), active_(true) {
+SceneNode::SceneNode()
+    : transform_(*this),
+      parent_(nullptr),
+      registry_(nullptr),
+      active_(true) {
+}
+
+SceneNode::~SceneNode() {
+  // Children unregister their own components as they are destroyed.
+  if (registry_ != nullptr) {
+    for (size_t i = 0; i < kNumComponentTypes; i++) {
+      if (components_[i] != nullptr)
+        registry_->Unregister(ComponentType(i), components_[i].get());
+    }
+  }
 }
 
 void SceneNode::AddChild(std::unique_ptr<SceneNode> child) {
   child->parent_ = this;
+  // The child's world matrices now depend on this node.
+  child->transform_.MarkWorldDirty();
+  if (child->registry_ != registry_)
+    child->SetRegistry(registry_);
   children_.emplace_back(std::move(child));
 }
 
-ComponentBase* SceneNode::GetComponentPtrByType(ComponentType type) const {
-  if (IsActive() && component_dict_.count(type)) {
-    return component_dict_.at(type).get();
+void SceneNode::SetRegistry(ComponentRegistry* registry) {
+  for (size_t i = 0; i < kNumComponentTypes; i++) {
+    ComponentBase* component = components_[i].get();
+    if (component == nullptr)
+      continue;
+    if (registry_ != nullptr)
+      registry_->Unregister(ComponentType(i), component);
+    if (registry != nullptr)
+      registry->Register(ComponentType(i), component);
+  }
+  registry_ = registry;
+  UpdateRenderRecord();
+  for (auto& child : children_) {
+    child->SetRegistry(registry);
   }
-  return nullptr;
+}
+
+void SceneNode::SetComponentByType(ComponentType type,
+                                   std::unique_ptr<ComponentBase> component) {
+  auto& slot = components_[size_t(type)];
+  if (registry_ != nullptr) {
+    if (slot != nullptr)
+      registry_->Unregister(type, slot.get());
+    if (component != nullptr)
+      registry_->Register(type, component.get());
+  }
+  slot = std::move(component);
+  UpdateRenderRecord();
+}
+
+void SceneNode::UpdateRenderRecord() {
+  auto rendering = static_cast<RenderingComponent*>(
+      components_[size_t(ComponentType::Rendering)].get());
+  if (registry_ == nullptr || rendering == nullptr)
+    return;
+  RenderRecord& record = registry_->GetRenderRecord(*rendering);
+  auto shading = static_cast<ShadingComponent*>(
+      components_[size_t(ComponentType::Shading)].get());
+  auto material = static_cast<MaterialComponent*>(
+      components_[size_t(ComponentType::Material)].get());
+  record.shader = shading == nullptr ? nullptr : shading->GetShaderPtr();
+  record.material = material == nullptr ? nullptr : &material->GetMaterial();
+  record.world_matrix = &transform_.world_mat_;
+  record.active = active_;
+}
+
+void SceneNode::MarkRenderRecordDirty() {
+  auto rendering = static_cast<RenderingComponent*>(
+      components_[size_t(ComponentType::Rendering)].get());
+  if (registry_ != nullptr && rendering != nullptr)
+    registry_->GetRenderRecord(*rendering).world_dirty = true;
 }
 
 std::vector<ComponentBase*> SceneNode::GetComponentsPtrInChildrenByType(
@@ -1,9 +1,9 @@
 #ifndef GLOO_SCENE_NODE_H_
 #define GLOO_SCENE_NODE_H_
 
+#include <array>
 #include <vector>
 #include <memory>
-#include <unordered_map>
 #include <iostream>
 #include <typeinfo>
 #include <stdexcept>
@@ -11,6 +11,7 @@
 #include <glm/vec3.hpp>
 
 #include "components/ComponentBase.hpp"
+#include "components/ComponentRegistry.hpp"
 #include "components/ComponentType.hpp"
 #include "Transform.hpp"
 
@@ -18,8 +19,7 @@ namespace GLOO {
 class SceneNode {
  public:
   SceneNode();
-  virtual ~SceneNode() {
-  }
+  virtual ~SceneNode();
 
   size_t GetChildrenCount() const {
     return children_.size();
@@ -38,14 +38,14 @@ class SceneNode {
   template <class T>
   void AddComponent(std::unique_ptr<T> component) {
     component->SetNodePtr(this);
-    component_dict_[ComponentTrait<T>::GetType()] = std::move(component);
+    SetComponentByType(ComponentTrait<T>::GetType(), std::move(component));
   }
 
   template <class T>
   bool RemoveComponent() {
-    auto itr = component_dict_.find(ComponentTrait<T>::GetType());
-    if (itr != component_dict_.end()) {
-      component_dict_.erase(itr);
+    auto& slot = components_[size_t(ComponentTrait<T>::GetType())];
+    if (slot != nullptr) {
+      SetComponentByType(ComponentTrait<T>::GetType(), nullptr);
       return true;
     }
     return false;
@@ -88,26 +88,46 @@ class SceneNode {
   }
   void SetActive(bool new_state) {
     active_ = new_state;
+    UpdateRenderRecord();
   }
 
   virtual void Update(double delta_time) {
   }
 
+  // Registers the components of this subtree with registry (nullptr to
+  // unregister them), and those added to it later. Done by Scene for its
+  // root; children added with AddChild join their parent's registry.
+  void SetRegistry(ComponentRegistry* registry);
+  // Copies the shader, material and state of this node into its render
+  // record, if it has a rendering component in a registry. Components call
+  // it when what they hand the renderer changes.
+  void UpdateRenderRecord();
+
  private:
-  ComponentBase* GetComponentPtrByType(ComponentType type) const;
+  friend class Transform;
+
+  ComponentBase* GetComponentPtrByType(ComponentType type) const {
+    if (IsActive()) {
+      return components_[size_t(type)].get();
+    }
+    return nullptr;
+  }
+  void SetComponentByType(ComponentType type,
+                          std::unique_ptr<ComponentBase> component);
   std::vector<ComponentBase*> GetComponentsPtrInChildrenByType(
       ComponentType type) const;
   void GatherComponentPtrsRecursivelyByType(
       ComponentType type,
       std::vector<ComponentBase*>& result) const;
+  // Called by the transform when its cached world matrix becomes stale.
+  void MarkRenderRecordDirty();
 
   Transform transform_;
-  std::unordered_map<ComponentType,
-                     std::unique_ptr<ComponentBase>,
-                     EnumClassHash>
-      component_dict_;
+  // Indexed by ComponentType; at most one component of each type.
+  std::array<std::unique_ptr<ComponentBase>, kNumComponentTypes> components_;
   std::vector<std::unique_ptr<SceneNode>> children_;
   SceneNode* parent_;
+  ComponentRegistry* registry_;
   bool active_;
 };
 }  // namespace GLOO
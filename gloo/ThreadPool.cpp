@@ -0,0 +1,121 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace GLOO {
+namespace {
+// Set while a thread is executing chunks, so that nested ParallelFor calls
+// run inline instead of waiting on the pool they are part of.
+thread_local bool in_parallel_region = false;
+}  // namespace
+
+ThreadPool::ThreadPool() {
+  size_t num_threads = std::thread::hardware_concurrency();
+  StartWorkers(std::max<size_t>(num_threads, 1) - 1);
+}
+
+ThreadPool::~ThreadPool() {
+  StopWorkers();
+}
+
+void ThreadPool::SetNumThreads(size_t num_threads) {
+  std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+  StopWorkers();
+  StartWorkers(std::max<size_t>(num_threads, 1) - 1);
+}
+
+size_t ThreadPool::GetNumThreads() const {
+  return workers_.size() + 1;
+}
+
+void ThreadPool::Run(size_t count,
+                     size_t grain,
+                     ChunkFunction function,
+                     void* context) {
+  if (count == 0)
+    return;
+  grain = std::max<size_t>(grain, 1);
+  size_t num_chunks = (count + grain - 1) / grain;
+
+  if (workers_.empty() || num_chunks == 1 || in_parallel_region ||
+      !submit_mutex_.try_lock()) {
+    for (size_t begin = 0; begin < count; begin += grain) {
+      function(context, begin, std::min(begin + grain, count));
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> submit_lock(submit_mutex_, std::adopt_lock);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    function_ = function;
+    context_ = context;
+    count_ = count;
+    grain_ = grain;
+    num_chunks_ = num_chunks;
+    next_chunk_ = 0;
+    busy_workers_ = workers_.size();
+    generation_++;
+  }
+  job_ready_.notify_all();
+
+  RunChunks();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  job_done_.wait(lock, [this] { return busy_workers_ == 0; });
+}
+
+void ThreadPool::RunChunks() {
+  in_parallel_region = true;
+  size_t chunk;
+  while ((chunk = next_chunk_++) < num_chunks_) {
+    size_t begin = chunk * grain_;
+    function_(context_, begin, std::min(begin + grain_, count_));
+  }
+  in_parallel_region = false;
+}
+
+void ThreadPool::WorkerLoop(size_t seen_generation) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      job_ready_.wait(lock, [&] {
+        return stopping_ || generation_ != seen_generation;
+      });
+      if (stopping_)
+        return;
+      seen_generation = generation_;
+    }
+
+    RunChunks();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--busy_workers_ == 0)
+      job_done_.notify_one();
+  }
+}
+
+void ThreadPool::StartWorkers(size_t num_workers) {
+  size_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+    generation = generation_;
+  }
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back([this, generation] { WorkerLoop(generation); });
+  }
+}
+
+void ThreadPool::StopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  job_ready_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+}  // namespace GLOO
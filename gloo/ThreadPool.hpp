@@ -0,0 +1,85 @@
+#ifndef GLOO_THREAD_POOL_H_
+#define GLOO_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace GLOO {
+class ThreadPool {
+ public:
+  // Singleton design pattern.
+  // ThreadPool is initialized the first time GetInstance is called, with one
+  // thread per hardware core.
+  static ThreadPool& GetInstance() {
+    static ThreadPool _instance;
+    return _instance;
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  void operator=(const ThreadPool&) = delete;
+
+  // Total number of threads working on a ParallelFor, counting the calling
+  // thread. 1 runs everything inline. Must not be called while a
+  // ParallelFor is running.
+  void SetNumThreads(size_t num_threads);
+  size_t GetNumThreads() const;
+
+  // Calls fn(begin, end) on disjoint chunks covering [0, count) and returns
+  // once all of them are done. Chunks are grain items long (the last one may
+  // be shorter) whatever the thread count, so an fn that only writes inside
+  // its own range gives identical results with any number of threads. Idle
+  // threads claim the next unprocessed chunk, which balances uneven work.
+  // Calls made from inside a chunk, or while another thread is using the
+  // pool, run inline. fn must not throw.
+  template <class Fn>
+  void ParallelFor(size_t count, size_t grain, Fn&& fn) {
+    using FnType = typename std::remove_reference<Fn>::type;
+    Run(count, grain,
+        [](void* context, size_t begin, size_t end) {
+          (*static_cast<FnType*>(context))(begin, end);
+        },
+        const_cast<void*>(static_cast<const void*>(&fn)));
+  }
+
+ private:
+  // Type-erased chunk body; avoids std::function so that dispatching a loop
+  // does not allocate.
+  using ChunkFunction = void (*)(void*, size_t, size_t);
+
+  ThreadPool();
+  ~ThreadPool();
+
+  void Run(size_t count, size_t grain, ChunkFunction function, void* context);
+  void RunChunks();
+  // Waits for jobs newer than seen_generation until the pool stops.
+  void WorkerLoop(size_t seen_generation);
+  void StartWorkers(size_t num_workers);
+  void StopWorkers();
+
+  std::vector<std::thread> workers_;
+  // Held by the thread that owns the current job.
+  std::mutex submit_mutex_;
+
+  std::mutex mutex_;
+  std::condition_variable job_ready_;
+  std::condition_variable job_done_;
+  size_t generation_{0};
+  size_t busy_workers_{0};
+  bool stopping_{false};
+
+  // The current job; written under mutex_ before generation_ is bumped.
+  ChunkFunction function_{nullptr};
+  void* context_{nullptr};
+  size_t count_{0};
+  size_t grain_{1};
+  size_t num_chunks_{0};
+  std::atomic<size_t> next_chunk_{0};
+};
+}  // namespace GLOO
+
+#endif
@@ -12,8 +12,8 @@ Transform::Transform(SceneNode& node)
     : position_(0.f),
       rotation_(glm::quat(1.f, 0.f, 0.f, 0.f)),
       scale_(glm::vec3(1.f)),
+      world_dirty_(true),
       node_(node) {
-  UNUSED(node_);
   UpdateLocalTransformMatrix();
 }
 
@@ -70,7 +70,7 @@ glm::vec3 Transform::GetWorldForward() {
 }
 
 glm::vec3 Transform::GetWorldPosition() const {
-  return glm::vec3(GetLocalToWorldMatrix() * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+  return glm::vec3(GetLocalToWorldMatrix()[3]);
 }
 
 glm::mat4 Transform::GetLocalToParentMatrix() const {
@@ -90,8 +90,39 @@ glm::mat4 Transform::GetLocalToAncestorMatrix(SceneNode* ancestor) const {
   }
 }
 
-glm::mat4 Transform::GetLocalToWorldMatrix() const {
-  return GetLocalToAncestorMatrix(nullptr);
+const glm::mat4& Transform::GetLocalToWorldMatrix() const {
+  if (world_dirty_)
+    UpdateWorldMatrices();
+  return world_mat_;
+}
+
+const glm::mat3& Transform::GetLocalToWorldNormalMatrix() const {
+  if (world_dirty_)
+    UpdateWorldMatrices();
+  return world_normal_mat_;
+}
+
+void Transform::UpdateWorldMatrices() const {
+  SceneNode* parent = node_.GetParentPtr();
+  if (parent == nullptr) {
+    world_mat_ = local_transform_mat_;
+  } else {
+    world_mat_ =
+        parent->GetTransform().GetLocalToWorldMatrix() * local_transform_mat_;
+  }
+  world_normal_mat_ = glm::transpose(glm::inverse(glm::mat3(world_mat_)));
+  world_dirty_ = false;
+}
+
+void Transform::MarkWorldDirty() {
+  if (world_dirty_)
+    return;
+  world_dirty_ = true;
+  node_.MarkRenderRecordDirty();
+  size_t child_count = node_.GetChildrenCount();
+  for (size_t i = 0; i < child_count; i++) {
+    node_.GetChild(i).GetTransform().MarkWorldDirty();
+  }
 }
 
 void Transform::UpdateLocalTransformMatrix() {
@@ -103,5 +134,6 @@ void Transform::UpdateLocalTransformMatrix() {
   new_matrix = glm::translate(glm::mat4(1.f), position_) * new_matrix;
 
   local_transform_mat_ = std::move(new_matrix);
+  MarkWorldDirty();
 }
 }  // namespace GLOO
@@ -26,7 +26,11 @@ class Transform {
     return scale_;
   }
   glm::vec3 GetWorldPosition() const;
-  glm::mat4 GetLocalToWorldMatrix() const;
+  // The world matrix and its normal matrix are cached, and recomputed only
+  // after this transform or one of its ancestors changed.
+  const glm::mat4& GetLocalToWorldMatrix() const;
+  // Inverse transpose of the upper 3x3 of GetLocalToWorldMatrix.
+  const glm::mat3& GetLocalToWorldNormalMatrix() const;
   glm::mat4 GetLocalToParentMatrix() const;
   glm::mat4 GetLocalToAncestorMatrix(SceneNode* ancestor) const;
   glm::vec3 GetForwardDirection() const;
@@ -37,7 +41,14 @@ class Transform {
   static glm::vec3 GetWorldForward();
 
  private:
+  friend class SceneNode;
+
   void UpdateLocalTransformMatrix();
+  // Flags the cached world matrices of this node and its descendants as
+  // stale. A stale node's descendants are always stale too, so marking
+  // stops at nodes that already are.
+  void MarkWorldDirty();
+  void UpdateWorldMatrices() const;
 
   glm::vec3 position_;
   glm::quat rotation_;
@@ -45,6 +56,10 @@ class Transform {
 
   glm::mat4 local_transform_mat_;
 
+  mutable glm::mat4 world_mat_;
+  mutable glm::mat3 world_normal_mat_;
+  mutable bool world_dirty_;
+
   SceneNode& node_;
 };
 
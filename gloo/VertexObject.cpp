@@ -1,5 +1,8 @@
 #include "VertexObject.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <iostream>
 #include <stdexcept>
@@ -9,43 +12,112 @@
 
 namespace GLOO {
 void VertexObject::UpdatePositions(std::unique_ptr<PositionArray> positions) {
-  if (positions_ == nullptr) {
-    vertex_array_->CreatePositionBuffer();
+  if (!vertex_array_->HasPositionBuffer()) {
+    vertex_array_->CreatePositionBuffer(usage_);
   }
   positions_ = std::move(positions);
   vertex_array_->UpdatePositions(*positions_);
+  bounding_box_dirty_ = true;
+}
+
+const BoundingBox& VertexObject::GetBoundingBox() const {
+  if (bounding_box_dirty_) {
+    bounding_box_ = positions_ == nullptr
+                        ? BoundingBox()
+                        : BoundingBox::FromPoints(*positions_);
+    bounding_box_dirty_ = false;
+  }
+  return bounding_box_;
 }
 
 void VertexObject::UpdateIndices(std::unique_ptr<IndexArray> indices) {
-  if (indices_ == nullptr) {
-    vertex_array_->CreateIndexBuffer();
+  if (!vertex_array_->HasIndexBuffer()) {
+    vertex_array_->CreateIndexBuffer(GetIndexUsage());
   }
   indices_ = std::move(indices);
-  vertex_array_->UpdateIndices(*indices_);
+  UploadIndexData(indices_->data(), indices_->size());
 }
 
 void VertexObject::UpdateNormals(std::unique_ptr<NormalArray> normals) {
-  if (normals_ == nullptr) {
-    vertex_array_->CreateNormalBuffer();
+  if (!vertex_array_->HasNormalBuffer()) {
+    vertex_array_->CreateNormalBuffer(usage_);
   }
   normals_ = std::move(normals);
   vertex_array_->UpdateNormals(*normals_);
 }
 
 void VertexObject::UpdateColors(std::unique_ptr<ColorArray> colors) {
-  if (colors_ == nullptr) {
-    vertex_array_->CreateColorBuffer();
+  if (!vertex_array_->HasColorBuffer()) {
+    vertex_array_->CreateColorBuffer(usage_);
   }
   colors_ = std::move(colors);
   vertex_array_->UpdateColors(*colors_);
 }
 
 void VertexObject::UpdateTexCoord(std::unique_ptr<TexCoordArray> tex_coords) {
-  if (tex_coords_ == nullptr) {
-    vertex_array_->CreateTexCoordBuffer();
+  if (!vertex_array_->HasTexCoordBuffer()) {
+    vertex_array_->CreateTexCoordBuffer(usage_);
   }
   tex_coords_ = std::move(tex_coords);
   vertex_array_->UpdateTexCoords(*tex_coords_);
 }
 
+void VertexObject::UploadPositions(const glm::vec3* positions, size_t count) {
+  UploadPositions(positions, count, BoundingBox::FromPoints(positions, count));
+}
+
+void VertexObject::UploadPositions(const glm::vec3* positions,
+                                   size_t count,
+                                   const BoundingBox& bounds) {
+  if (!vertex_array_->HasPositionBuffer()) {
+    vertex_array_->CreatePositionBuffer(usage_);
+  }
+  positions_.reset();
+  vertex_array_->UpdatePositions(positions, count);
+  bounding_box_ = bounds;
+  bounding_box_dirty_ = false;
+}
+
+void VertexObject::UploadNormals(const glm::vec3* normals, size_t count) {
+  if (!vertex_array_->HasNormalBuffer()) {
+    vertex_array_->CreateNormalBuffer(usage_);
+  }
+  normals_.reset();
+  vertex_array_->UpdateNormals(normals, count);
+}
+
+void VertexObject::UploadTexCoords(const glm::vec2* tex_coords, size_t count) {
+  if (!vertex_array_->HasTexCoordBuffer()) {
+    vertex_array_->CreateTexCoordBuffer(usage_);
+  }
+  tex_coords_.reset();
+  vertex_array_->UpdateTexCoords(tex_coords, count);
+}
+
+void VertexObject::UploadIndices(const unsigned int* indices, size_t count) {
+  if (!vertex_array_->HasIndexBuffer()) {
+    vertex_array_->CreateIndexBuffer(GetIndexUsage());
+  }
+  indices_.reset();
+  UploadIndexData(indices, count);
+}
+
+void VertexObject::UploadIndexData(const unsigned int* indices, size_t count) {
+  // The CPU copy stays 32-bit. Only Static buffers are narrowed: they are
+  // written once, while the others would pay for the scan on every update.
+  if (usage_ == BufferUsage::Static && count > 0 &&
+      *std::max_element(indices, indices + count) <=
+          std::numeric_limits<uint16_t>::max()) {
+    std::vector<uint16_t> narrow(indices, indices + count);
+    vertex_array_->UpdateIndices(narrow.data(), narrow.size());
+  } else {
+    vertex_array_->UpdateIndices(indices, count);
+  }
+}
+
+BufferUsage VertexObject::GetIndexUsage() const {
+  return usage_ == BufferUsage::Static ? BufferUsage::Static
+                                       : BufferUsage::Dynamic;
+}
+
 }  // namespace GLOO
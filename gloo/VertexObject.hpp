@@ -2,13 +2,19 @@
 #define GLOO_VERTEX_OBJECT_H_
 
 #include "gloo/gl_wrapper/VertexArray.hpp"
+#include "gloo/BoundingBox.hpp"
 
 namespace GLOO {
 // Instances of this class store various vertex data and are responsible
 // for sending data from CPU to GPU via the Update* methods.
 class VertexObject {
  public:
-  VertexObject() : vertex_array_(make_unique<VertexArray>()) {
+  // usage applies to the vertex attribute buffers. The index buffer is
+  // Static for Static objects and Dynamic otherwise, since indices are
+  // normally rewritten much less often than vertex data. Static objects
+  // whose indices all fit in 16 bits upload them as such.
+  explicit VertexObject(BufferUsage usage = BufferUsage::Static)
+      : vertex_array_(make_unique<VertexArray>()), usage_(usage) {
   }
 
   // Vertex buffers are created in a lazy manner in the following Update*.
@@ -18,6 +24,20 @@ class VertexObject {
   void UpdateTexCoord(std::unique_ptr<TexCoordArray> tex_coords);
   void UpdateIndices(std::unique_ptr<IndexArray> indices);
 
+  // Upload count elements straight from memory the caller owns, e.g. a
+  // mapped MeshCache or a staging array reused every frame, without keeping
+  // a CPU copy: the matching Has* returns false and Get* throws until the
+  // next Update*. The data is only read during the call.
+  void UploadPositions(const glm::vec3* positions, size_t count);
+  // Same, with bounds the caller already knows to contain the positions,
+  // which saves the scan over them.
+  void UploadPositions(const glm::vec3* positions,
+                       size_t count,
+                       const BoundingBox& bounds);
+  void UploadNormals(const glm::vec3* normals, size_t count);
+  void UploadTexCoords(const glm::vec2* tex_coords, size_t count);
+  void UploadIndices(const unsigned int* indices, size_t count);
+
   bool HasPositions() const {
     return positions_ != nullptr;
   }
@@ -68,6 +88,11 @@ class VertexObject {
     return *indices_;
   }
 
+  // Bounds of the positions in object space, recomputed on the first call
+  // after UpdatePositions and computed right away by UploadPositions (or
+  // given to it). Empty if there are no positions.
+  const BoundingBox& GetBoundingBox() const;
+
   VertexArray& GetVertexArray() {
     return *vertex_array_.get();
   }
@@ -76,7 +101,11 @@ class VertexObject {
   }
 
  private:
+  BufferUsage GetIndexUsage() const;
+  void UploadIndexData(const unsigned int* indices, size_t count);
+
   std::unique_ptr<VertexArray> vertex_array_;
+  BufferUsage usage_;
 
   // Owner of vertex data.
   std::unique_ptr<PositionArray> positions_;
@@ -84,6 +113,9 @@ class VertexObject {
   std::unique_ptr<ColorArray> colors_;
   std::unique_ptr<TexCoordArray> tex_coords_;
   std::unique_ptr<IndexArray> indices_;
+
+  mutable BoundingBox bounding_box_;
+  mutable bool bounding_box_dirty_{true};
 };
 
 }  // namespace GLOO
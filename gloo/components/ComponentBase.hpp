@@ -5,6 +5,7 @@
 
 namespace GLOO {
 class SceneNode;
+class ComponentRegistry;
 
 class ComponentBase {
  public:
@@ -18,7 +19,12 @@ class ComponentBase {
   }
 
  protected:
-  SceneNode* node_ptr_;
+  SceneNode* node_ptr_{nullptr};
+
+ private:
+  friend class ComponentRegistry;
+  // Position in the registry of the scene the node belongs to, if any.
+  size_t registry_index_{0};
 };
 }  // namespace GLOO
 
@@ -0,0 +1,55 @@
+#include "ComponentRegistry.hpp"
+
+#include <stdexcept>
+
+#include "gloo/SceneNode.hpp"
+#include "RenderingComponent.hpp"
+
+namespace GLOO {
+void ComponentRegistry::Register(ComponentType type, ComponentBase* component) {
+  auto& components = components_[size_t(type)];
+  component->registry_index_ = components.size();
+  components.push_back(component);
+  if (type == ComponentType::Rendering) {
+    // The node fills in the rest.
+    render_records_.push_back({static_cast<RenderingComponent*>(component),
+                               nullptr, nullptr, nullptr, true, true});
+  }
+}
+
+void ComponentRegistry::Unregister(ComponentType type,
+                                   ComponentBase* component) {
+  auto& components = components_[size_t(type)];
+  size_t index = component->registry_index_;
+  if (index >= components.size() || components[index] != component) {
+    throw std::runtime_error("Component is not in this registry!");
+  }
+  // Fill the hole with the last component to keep the array dense.
+  components[index] = components.back();
+  components[index]->registry_index_ = index;
+  components.pop_back();
+  if (type == ComponentType::Rendering) {
+    render_records_[index] = render_records_.back();
+    render_records_.pop_back();
+  }
+}
+
+RenderRecord& ComponentRegistry::GetRenderRecord(
+    const RenderingComponent& rendering) {
+  size_t index = rendering.registry_index_;
+  if (index >= render_records_.size() ||
+      render_records_[index].rendering != &rendering) {
+    throw std::runtime_error("Component is not in this registry!");
+  }
+  return render_records_[index];
+}
+
+void ComponentRegistry::UpdateWorldMatrices() const {
+  for (RenderRecord& record : render_records_) {
+    if (!record.world_dirty)
+      continue;
+    record.rendering->GetNodePtr()->GetTransform().GetLocalToWorldMatrix();
+    record.world_dirty = false;
+  }
+}
+}  // namespace GLOO
@@ -0,0 +1,66 @@
+#ifndef GLOO_COMPONENT_REGISTRY_H_
+#define GLOO_COMPONENT_REGISTRY_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ComponentBase.hpp"
+
+namespace GLOO {
+class RenderingComponent;
+class ShaderProgram;
+class Material;
+
+// What the renderer needs of a node with a rendering component, kept
+// up to date by the node so that building the render queue reads one dense
+// array instead of the nodes.
+struct RenderRecord {
+  RenderingComponent* rendering;
+  // nullptr if the node has no shading or material component.
+  ShaderProgram* shader;
+  const Material* material;
+  // The node's cached world matrix, valid while world_dirty is false.
+  const glm::mat4* world_matrix;
+  bool world_dirty;
+  bool active;
+};
+
+// Keeps, for each component type, a dense array of every component attached
+// to the nodes of one scene, so that systems such as the renderer can visit
+// all components of a type linearly instead of walking the node tree and
+// looking each one up. Nodes register and unregister their components as
+// they join the scene or gain and lose components; the order of an array
+// changes when components are removed. Each rendering component also has a
+// RenderRecord, at the same index.
+class ComponentRegistry {
+ public:
+  void Register(ComponentType type, ComponentBase* component);
+  void Unregister(ComponentType type, ComponentBase* component);
+
+  RenderRecord& GetRenderRecord(const RenderingComponent& rendering);
+  const std::vector<RenderRecord>& GetRenderRecords() const {
+    return render_records_;
+  }
+  // Recomputes the world matrices of the records flagged as dirty.
+  void UpdateWorldMatrices() const;
+
+  template <class T>
+  size_t GetCount() const {
+    return components_[size_t(ComponentTrait<T>::GetType())].size();
+  }
+
+  template <class T>
+  T* Get(size_t index) const {
+    return static_cast<T*>(
+        components_[size_t(ComponentTrait<T>::GetType())][index]);
+  }
+
+ private:
+  std::vector<ComponentBase*> components_[kNumComponentTypes];
+  // Mutable like the world matrix caches they point to.
+  mutable std::vector<RenderRecord> render_records_;
+};
+}  // namespace GLOO
+
+#endif
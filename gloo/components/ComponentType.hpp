@@ -1,6 +1,7 @@
 #ifndef GLOO_COMPONENT_TYPE_H_
 #define GLOO_COMPONENT_TYPE_H_
 
+#include <cstddef>
 #include <typeinfo>
 
 #include "gloo/utils.hpp"
@@ -16,6 +17,9 @@ enum class ComponentType {
   Tracing,
 };
 
+// Number of ComponentType values; keep in sync with the last one above.
+const size_t kNumComponentTypes = size_t(ComponentType::Tracing) + 1;
+
 template <typename T>
 struct ComponentTrait {
   static ComponentType GetType() {
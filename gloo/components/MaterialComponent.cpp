@@ -0,0 +1,12 @@
+#include "MaterialComponent.hpp"
+
+#include "gloo/SceneNode.hpp"
+
+namespace GLOO {
+void MaterialComponent::SetMaterial(std::shared_ptr<Material> material) {
+  material_ = std::move(material);
+  // The node's render record points at the material.
+  if (node_ptr_ != nullptr)
+    node_ptr_->UpdateRenderRecord();
+}
+}  // namespace GLOO
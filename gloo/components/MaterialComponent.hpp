@@ -12,9 +12,7 @@ class MaterialComponent : public ComponentBase {
     SetMaterial(std::move(material));
   }
 
-  void SetMaterial(std::shared_ptr<Material> material) {
-    material_ = std::move(material);
-  }
+  void SetMaterial(std::shared_ptr<Material> material);
 
   Material& GetMaterial() {
     return *material_;
@@ -6,7 +6,8 @@
 namespace GLOO {
 RenderingComponent::RenderingComponent(std::shared_ptr<VertexObject> vertex_obj)
     : vertex_obj_(std::move(vertex_obj)) {
-  if (!vertex_obj_->HasIndices() && !vertex_obj_->HasPositions()) {
+  const VertexArray& vertex_array = vertex_obj_->GetVertexArray();
+  if (!vertex_array.HasIndexBuffer() && !vertex_array.HasPositionBuffer()) {
     throw std::runtime_error(
         "Cannot initialize a "
         "RenderingComponent with a VertexObject without positions!");
@@ -23,19 +24,31 @@ void RenderingComponent::SetDrawRange(int start_index, int num_indices) {
 }
 
 void RenderingComponent::Render() const {
+  size_t start_index, num_indices;
+  GetDrawRange(start_index, num_indices);
+  vertex_obj_->GetVertexArray().Render(start_index, num_indices);
+}
+
+void RenderingComponent::Draw() const {
+  size_t start_index, num_indices;
+  GetDrawRange(start_index, num_indices);
+  vertex_obj_->GetVertexArray().Draw(start_index, num_indices);
+}
+
+void RenderingComponent::GetDrawRange(size_t& start_index,
+                                      size_t& num_indices) const {
   if (vertex_obj_ == nullptr) {
     throw std::runtime_error(
         "Rendering component has no vertex object attached!");
   }
   if (start_index_ >= 0 && num_indices_ > 0) {
-    vertex_obj_->GetVertexArray().Render(static_cast<size_t>(start_index_),
-                                         static_cast<size_t>(num_indices_));
+    start_index = static_cast<size_t>(start_index_);
+    num_indices = static_cast<size_t>(num_indices_);
   } else {
-    if (vertex_obj_->HasIndices())
-      vertex_obj_->GetVertexArray().Render(0, vertex_obj_->GetIndices().size());
-    else
-      vertex_obj_->GetVertexArray().Render(0,
-                                           vertex_obj_->GetPositions().size());
+    start_index = 0;
+    // Taken from the GPU buffers, which also exist for data uploaded
+    // without a CPU copy.
+    num_indices = vertex_obj_->GetVertexArray().GetElementCount();
   }
 }
 
@@ -18,8 +18,12 @@ class RenderingComponent : public ComponentBase {
   }
 
   void Render() const;
+  // Same as Render, for callers that have bound the VAO themselves.
+  void Draw() const;
 
  private:
+  void GetDrawRange(size_t& start_index, size_t& num_indices) const;
+
   std::shared_ptr<VertexObject> vertex_obj_;
   int start_index_;
   int num_indices_;
@@ -0,0 +1,34 @@
+#ifndef GLOO_UNIFORM_BUFFER_H_
+#define GLOO_UNIFORM_BUFFER_H_
+
+#include "BindableBuffer.hpp"
+
+#include <glad/glad.h>
+
+#include "BindGuard.hpp"
+#include "gloo/utils.hpp"
+
+namespace GLOO {
+// Backing storage of a uniform block shared by every program that uses the
+// block. T must match the block's std140 layout.
+template <class T>
+class UniformBuffer : public BindableBuffer {
+ public:
+  UniformBuffer() : BindableBuffer(GL_UNIFORM_BUFFER) {
+    BindGuard bg(this);
+    GL_CHECK(glBufferData(target_, sizeof(T), nullptr, GL_DYNAMIC_DRAW));
+  }
+
+  void Update(const T& block) const {
+    BindGuard bg(this);
+    GL_CHECK(glBufferSubData(target_, 0, sizeof(T), &block));
+  }
+
+  // Makes programs whose block is bound to binding read from this buffer.
+  void BindBase(GLuint binding) const {
+    GL_CHECK(glBindBufferBase(target_, binding, GetHandle()));
+  }
+};
+}  // namespace GLOO
+
+#endif
@@ -25,6 +25,7 @@ VertexArray::VertexArray(VertexArray&& other) noexcept {
   color_buf_ = std::move(other.color_buf_);
   tex_coord_buf_ = std::move(other.tex_coord_buf_);
   idx_buf_ = std::move(other.idx_buf_);
+  index_type_ = other.index_type_;
   draw_mode_ = other.draw_mode_;
   polygon_mode_ = other.polygon_mode_;
 }
@@ -38,6 +39,7 @@ VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
   color_buf_ = std::move(other.color_buf_);
   tex_coord_buf_ = std::move(other.tex_coord_buf_);
   idx_buf_ = std::move(other.idx_buf_);
+  index_type_ = other.index_type_;
   draw_mode_ = other.draw_mode_;
   polygon_mode_ = other.polygon_mode_;
   return *this;
@@ -51,79 +53,115 @@ void VertexArray::Unbind() const {
   GL_CHECK(glBindVertexArray(0));
 }
 
-void VertexArray::CreatePositionBuffer() {
-  pos_buf_ = make_unique<PositionBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreatePositionBuffer(BufferUsage usage) {
+  pos_buf_ = make_unique<PositionBuffer>(usage);
+  LinkPositionBuffer();
 }
 
-void VertexArray::CreateNormalBuffer() {
-  normal_buf_ = make_unique<NormalBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreateNormalBuffer(BufferUsage usage) {
+  normal_buf_ = make_unique<NormalBuffer>(usage);
+  LinkNormalBuffer();
 }
 
-void VertexArray::CreateColorBuffer() {
-  color_buf_ = make_unique<ColorBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreateColorBuffer(BufferUsage usage) {
+  color_buf_ = make_unique<ColorBuffer>(usage);
+  LinkColorBuffer();
 }
 
-void VertexArray::CreateTexCoordBuffer() {
-  tex_coord_buf_ = make_unique<TexCoordBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreateTexCoordBuffer(BufferUsage usage) {
+  tex_coord_buf_ = make_unique<TexCoordBuffer>(usage);
+  LinkTexCoordBuffer();
 }
 
-void VertexArray::CreateIndexBuffer() {
-  idx_buf_ = make_unique<IndexBuffer>(GL_STATIC_DRAW);
+void VertexArray::CreateIndexBuffer(BufferUsage usage) {
+  idx_buf_ = make_unique<IndexBuffer>(usage);
   BindGuard vao_bg(this);
   // Different from other types of vertex buffers, EBOs should not be unbounded.
   idx_buf_->Bind();
 }
 
-void VertexArray::UpdatePositions(const PositionArray& positions) const {
-  pos_buf_->Update(positions);
+void VertexArray::UpdatePositions(const glm::vec3* positions,
+                                  size_t count) const {
+  if (pos_buf_->Update(positions, count))
+    LinkPositionBuffer();
 }
 
-void VertexArray::UpdateNormals(const NormalArray& normals) const {
-  normal_buf_->Update(normals);
+void VertexArray::UpdateNormals(const glm::vec3* normals, size_t count) const {
+  if (normal_buf_->Update(normals, count))
+    LinkNormalBuffer();
 }
 
-void VertexArray::UpdateColors(const ColorArray& colors) const {
-  color_buf_->Update(colors);
+void VertexArray::UpdateColors(const glm::vec4* colors, size_t count) const {
+  if (color_buf_->Update(colors, count))
+    LinkColorBuffer();
 }
 
-void VertexArray::UpdateTexCoords(const TexCoordArray& tex_coords) const {
-  tex_coord_buf_->Update(tex_coords);
+void VertexArray::UpdateTexCoords(const glm::vec2* tex_coords,
+                                  size_t count) const {
+  if (tex_coord_buf_->Update(tex_coords, count))
+    LinkTexCoordBuffer();
 }
 
-void VertexArray::UpdateIndices(const IndexArray& indices) const {
-  idx_buf_->Update(indices);
+void VertexArray::UpdateIndices(const unsigned int* indices,
+                                size_t count) const {
+  UpdateIndexBytes(indices, count, GL_UNSIGNED_INT);
 }
 
-void VertexArray::LinkPositionBuffer(GLuint attr_idx) const {
+void VertexArray::UpdateIndices(const uint16_t* indices, size_t count) const {
+  UpdateIndexBytes(indices, count, GL_UNSIGNED_SHORT);
+}
+
+void VertexArray::UpdateIndexBytes(const void* indices,
+                                   size_t count,
+                                   GLenum index_type) const {
+  index_type_ = index_type;
+  if (idx_buf_->Update(static_cast<const GLubyte*>(indices),
+                       count * GetIndexSize())) {
+    // The EBO binding is part of the VAO state.
+    BindGuard vao_bg(this);
+    idx_buf_->Bind();
+  }
+}
+
+size_t VertexArray::GetIndexSize() const {
+  return index_type_ == GL_UNSIGNED_SHORT ? sizeof(uint16_t)
+                                          : sizeof(unsigned int);
+}
+
+void VertexArray::LinkPositionBuffer() const {
   BindGuard vao_bg(this);
   BindGuard buf_bg(pos_buf_.get());
   // The line below attaches the vertex buffer to the VAO.
-  GL_CHECK(glVertexAttribPointer(attr_idx, 3, GL_FLOAT, GL_FALSE, 0, 0));
-  GL_CHECK(glEnableVertexAttribArray(attr_idx));
+  GL_CHECK(glVertexAttribPointer(kPositionAttribLocation, 3, GL_FLOAT, GL_FALSE,
+                                 0, 0));
+  GL_CHECK(glEnableVertexAttribArray(kPositionAttribLocation));
 }
 
-void VertexArray::LinkNormalBuffer(GLuint attr_idx) const {
+void VertexArray::LinkNormalBuffer() const {
   BindGuard vao_bg(this);
   BindGuard buf_bg(normal_buf_.get());
   // The line below attaches the vertex buffer to the VAO.
-  GL_CHECK(glVertexAttribPointer(attr_idx, 3, GL_FLOAT, GL_FALSE, 0, 0));
-  GL_CHECK(glEnableVertexAttribArray(attr_idx));
+  GL_CHECK(glVertexAttribPointer(kNormalAttribLocation, 3, GL_FLOAT, GL_FALSE,
+                                 0, 0));
+  GL_CHECK(glEnableVertexAttribArray(kNormalAttribLocation));
 }
 
-void VertexArray::LinkColorBuffer(GLuint attr_idx) const {
+void VertexArray::LinkColorBuffer() const {
   BindGuard vao_bg(this);
   BindGuard buf_bg(color_buf_.get());
   // The line below attaches the vertex buffer to the VAO.
-  GL_CHECK(glVertexAttribPointer(attr_idx, 4, GL_FLOAT, GL_FALSE, 0, 0));
-  GL_CHECK(glEnableVertexAttribArray(attr_idx));
+  GL_CHECK(glVertexAttribPointer(kColorAttribLocation, 4, GL_FLOAT, GL_FALSE,
+                                 0, 0));
+  GL_CHECK(glEnableVertexAttribArray(kColorAttribLocation));
 }
 
-void VertexArray::LinkTexCoordBuffer(GLuint attr_idx) const {
+void VertexArray::LinkTexCoordBuffer() const {
   BindGuard vao_bg(this);
   BindGuard buf_bg(tex_coord_buf_.get());
   // The line below attaches the vertex buffer to the VAO.
-  GL_CHECK(glVertexAttribPointer(attr_idx, 2, GL_FLOAT, GL_FALSE, 0, 0));
-  GL_CHECK(glEnableVertexAttribArray(attr_idx));
+  GL_CHECK(glVertexAttribPointer(kTexCoordAttribLocation, 2, GL_FLOAT, GL_FALSE,
+                                 0, 0));
+  GL_CHECK(glEnableVertexAttribArray(kTexCoordAttribLocation));
 }
 
 void VertexArray::SetDrawMode(DrawMode mode) {
@@ -139,7 +177,10 @@ void VertexArray::Render(size_t start_index, size_t num_indices) const {
   // to avoid alignment issues.
 
   BindGuard vao_bg(this);
+  Draw(start_index, num_indices);
+}
 
+void VertexArray::Draw(size_t start_index, size_t num_indices) const {
   if (polygon_mode_ == PolygonMode::Wireframe) {
     GL_CHECK(glPolygonMode(GL_FRONT_AND_BACK, GL_LINE));
   } else {
@@ -150,21 +191,23 @@ void VertexArray::Render(size_t start_index, size_t num_indices) const {
 
   if (idx_buf_ != nullptr) {
     GL_CHECK(glDrawElements(
-        draw_mode, static_cast<GLsizei>(num_indices), GL_UNSIGNED_INT,
-        reinterpret_cast<void*>(start_index * sizeof(unsigned int))));
+        draw_mode, static_cast<GLsizei>(num_indices), index_type_,
+        reinterpret_cast<void*>(start_index * GetIndexSize())));
   } else {
     GL_CHECK(glDrawArrays(draw_mode, (GLint)start_index, (GLsizei)num_indices));
   }
 }
 
 void VertexArray::Render() const {
+  Render(0, GetElementCount());
+}
+
+size_t VertexArray::GetElementCount() const {
   if (idx_buf_ != nullptr)
-    Render(0, idx_buf_->GetSize());
-  else {
-    if (pos_buf_ == nullptr)
-      throw std::runtime_error("Cannot render VertexArray without positions!");
-    Render(0, pos_buf_->GetSize());
-  }
+    return idx_buf_->GetSize() / GetIndexSize();
+  if (pos_buf_ == nullptr)
+    throw std::runtime_error("Cannot render VertexArray without positions!");
+  return pos_buf_->GetSize();
 }
 
 static_assert(std::is_move_constructible<VertexArray>(), "");
@@ -3,6 +3,8 @@
 
 #include "IBindable.hpp"
 
+#include <cstdint>
+
 #include "gloo/external.hpp"
 #include "gloo/alias_types.hpp"
 #include "VertexBuffer.hpp"
@@ -12,6 +14,14 @@ enum class DrawMode { Triangles, Lines };
 
 enum class PolygonMode { Wireframe, Fill };
 
+// Attribute locations shared by all shaders through layout(location = ...)
+// in the vertex shaders. A buffer is linked to its location once, when it
+// is created, so drawing with any shader needs no per-draw linking.
+const GLuint kPositionAttribLocation = 0;
+const GLuint kNormalAttribLocation = 1;
+const GLuint kColorAttribLocation = 2;
+const GLuint kTexCoordAttribLocation = 3;
+
 class VertexArray : public IBindable {
  public:
   VertexArray();
@@ -27,20 +37,36 @@ class VertexArray : public IBindable {
   void Bind() const override;
   void Unbind() const override;
 
-  void CreatePositionBuffer();
-  void CreateNormalBuffer();
-  void CreateColorBuffer();
-  void CreateTexCoordBuffer();
-  void CreateIndexBuffer();
-  void UpdatePositions(const PositionArray& positions) const;
-  void UpdateNormals(const NormalArray& normals) const;
-  void UpdateColors(const ColorArray& colors) const;
-  void UpdateTexCoords(const TexCoordArray& tex_coords) const;
-  void UpdateIndices(const IndexArray& indices) const;
-  void LinkPositionBuffer(GLuint attr_idx) const;
-  void LinkNormalBuffer(GLuint attr_idx) const;
-  void LinkColorBuffer(GLuint attr_idx) const;
-  void LinkTexCoordBuffer(GLuint attr_idx) const;
+  void CreatePositionBuffer(BufferUsage usage = BufferUsage::Static);
+  void CreateNormalBuffer(BufferUsage usage = BufferUsage::Static);
+  void CreateColorBuffer(BufferUsage usage = BufferUsage::Static);
+  void CreateTexCoordBuffer(BufferUsage usage = BufferUsage::Static);
+  void CreateIndexBuffer(BufferUsage usage = BufferUsage::Static);
+  void UpdatePositions(const PositionArray& positions) const {
+    UpdatePositions(positions.data(), positions.size());
+  }
+  void UpdateNormals(const NormalArray& normals) const {
+    UpdateNormals(normals.data(), normals.size());
+  }
+  void UpdateColors(const ColorArray& colors) const {
+    UpdateColors(colors.data(), colors.size());
+  }
+  void UpdateTexCoords(const TexCoordArray& tex_coords) const {
+    UpdateTexCoords(tex_coords.data(), tex_coords.size());
+  }
+  void UpdateIndices(const IndexArray& indices) const {
+    UpdateIndices(indices.data(), indices.size());
+  }
+  // Overloads reading count elements straight from memory the caller owns,
+  // such as a mapped file.
+  void UpdatePositions(const glm::vec3* positions, size_t count) const;
+  void UpdateNormals(const glm::vec3* normals, size_t count) const;
+  void UpdateColors(const glm::vec4* colors, size_t count) const;
+  void UpdateTexCoords(const glm::vec2* tex_coords, size_t count) const;
+  void UpdateIndices(const unsigned int* indices, size_t count) const;
+  // 16-bit indices, for meshes with at most 65536 vertices. They halve the
+  // index buffer and draw with GL_UNSIGNED_SHORT.
+  void UpdateIndices(const uint16_t* indices, size_t count) const;
 
   bool HasPositionBuffer() const {
     return pos_buf_ != nullptr;
@@ -66,6 +92,15 @@ class VertexArray : public IBindable {
   void SetPolygonMode(PolygonMode mode);
   void Render(size_t start_index, size_t num_indices) const;
   void Render() const;
+  // Number of indices drawn by Render(), or of vertices without an index
+  // buffer.
+  size_t GetElementCount() const;
+  // Same as Render, for callers that have bound this VAO themselves.
+  void Draw(size_t start_index, size_t num_indices) const;
+
+  GLuint GetHandle() const {
+    return handle_;
+  }
 
  private:
   // Buffers are invisible to the outside.
@@ -73,13 +108,26 @@ class VertexArray : public IBindable {
   using NormalBuffer = VertexBuffer<glm::vec3, GL_ARRAY_BUFFER>;
   using ColorBuffer = VertexBuffer<glm::vec4, GL_ARRAY_BUFFER>;
   using TexCoordBuffer = VertexBuffer<glm::vec2, GL_ARRAY_BUFFER>;
-  using IndexBuffer = VertexBuffer<unsigned int, GL_ELEMENT_ARRAY_BUFFER>;
+  // Raw bytes, holding indices of index_type_.
+  using IndexBuffer = VertexBuffer<GLubyte, GL_ELEMENT_ARRAY_BUFFER>;
+
+  // Attach the current buffer object to its fixed attribute location.
+  void LinkPositionBuffer() const;
+  void LinkNormalBuffer() const;
+  void LinkColorBuffer() const;
+  void LinkTexCoordBuffer() const;
+  void UpdateIndexBytes(const void* indices,
+                        size_t count,
+                        GLenum index_type) const;
+  size_t GetIndexSize() const;
 
   std::unique_ptr<PositionBuffer> pos_buf_;
   std::unique_ptr<NormalBuffer> normal_buf_;
   std::unique_ptr<ColorBuffer> color_buf_;
   std::unique_ptr<TexCoordBuffer> tex_coord_buf_;
   std::unique_ptr<IndexBuffer> idx_buf_;
+  // GL_UNSIGNED_INT or GL_UNSIGNED_SHORT, set by the last UpdateIndices.
+  mutable GLenum index_type_{GL_UNSIGNED_INT};
 
   DrawMode draw_mode_;
   PolygonMode polygon_mode_;
@@ -3,39 +3,154 @@
 
 #include "BindableBuffer.hpp"
 
+#include <stdexcept>
 #include <vector>
 
 #include <glad/glad.h>
 
 #include "BindGuard.hpp"
+#include "gloo/Profiler.hpp"
 #include "gloo/utils.hpp"
 
 namespace GLOO {
+// How often the contents of a buffer are replaced.
+enum class BufferUsage {
+  // Written once or rarely; every update allocates new storage.
+  Static,
+  // Rewritten often. Updates of the same size overwrite the existing storage
+  // with glBufferSubData; a size change orphans it for fresh storage.
+  Dynamic,
+  // Rewritten every frame. Updates cycle through a ring of buffer objects and
+  // only write one after a fence says the GPU is done reading it, so the CPU
+  // never waits on draws that are still in flight.
+  Stream,
+};
+
 template <class T, GLenum target>
 class VertexBuffer : public BindableBuffer {
  public:
-  VertexBuffer(GLenum usage);
-  void Update(const std::vector<T>& array);
+  VertexBuffer(BufferUsage usage);
+  ~VertexBuffer();
+
+  // Returns true if the data now lives in a different buffer object than
+  // before (only for BufferUsage::Stream), in which case VAOs that refer to
+  // it must be linked to it again.
+  bool Update(const std::vector<T>& array) {
+    return Update(array.data(), array.size());
+  }
+  // Same as above for count elements read from data, which only has to stay
+  // valid for the duration of the call.
+  bool Update(const T* data, size_t count);
   size_t GetSize() const {
     return size_;
   }
 
  private:
-  size_t size_;
-  GLenum usage_;
+  // Number of buffer objects a Stream buffer cycles through: one being
+  // written plus enough for the frames the GPU may still be drawing.
+  static const size_t kRingSize = 3;
+
+  struct RingSlot {
+    GLuint handle;
+    size_t capacity;
+    // Signaled once the GPU has executed every command issued before this
+    // slot was retired; 0 for a slot never used.
+    GLsync fence;
+  };
+
+  GLenum GetGLUsage() const;
+  void Upload(const T* data, size_t count);
+  void RotateRing();
+
+  size_t size_{0};
+  // Number of elements the current buffer object has storage for.
+  size_t capacity_{0};
+  BufferUsage usage_;
+  // Buffer objects other than the bound one, oldest first (Stream only).
+  std::vector<RingSlot> ring_;
 };
 
 template <class T, GLenum target>
-VertexBuffer<T, target>::VertexBuffer(GLenum usage)
+VertexBuffer<T, target>::VertexBuffer(BufferUsage usage)
     : BindableBuffer(target), usage_(usage) {
+  if (usage_ == BufferUsage::Stream) {
+    for (size_t i = 1; i < kRingSize; i++) {
+      RingSlot slot{0, 0, 0};
+      GL_CHECK(glGenBuffers(1, &slot.handle));
+      ring_.push_back(slot);
+    }
+  }
+}
+
+template <class T, GLenum target>
+VertexBuffer<T, target>::~VertexBuffer() {
+  for (auto& slot : ring_) {
+    if (slot.fence != 0)
+      GL_CHECK(glDeleteSync(slot.fence));
+    GL_CHECK(glDeleteBuffers(1, &slot.handle));
+  }
+}
+
+template <class T, GLenum target>
+bool VertexBuffer<T, target>::Update(const T* data, size_t count) {
+  ScopedCpuTimer timer("Buffer upload");
+  bool rotated = false;
+  if (usage_ == BufferUsage::Stream && capacity_ > 0) {
+    RotateRing();
+    rotated = true;
+  }
+  Upload(data, count);
+  return rotated;
+}
+
+template <class T, GLenum target>
+GLenum VertexBuffer<T, target>::GetGLUsage() const {
+  switch (usage_) {
+    case BufferUsage::Dynamic:
+      return GL_DYNAMIC_DRAW;
+    case BufferUsage::Stream:
+      return GL_STREAM_DRAW;
+    default:
+      return GL_STATIC_DRAW;
+  }
 }
 
 template <class T, GLenum target>
-void VertexBuffer<T, target>::Update(const std::vector<T>& array) {
+void VertexBuffer<T, target>::Upload(const T* data, size_t count) {
   BindGuard bg(this);
-  GL_CHECK(
-      glBufferData(target_, sizeof(T) * array.size(), array.data(), usage_));
-  size_ = array.size();
+  if (usage_ != BufferUsage::Static && count == capacity_ && capacity_ > 0) {
+    GL_CHECK(glBufferSubData(target_, 0, sizeof(T) * count, data));
+  } else {
+    GL_CHECK(glBufferData(target_, sizeof(T) * count, data, GetGLUsage()));
+    capacity_ = count;
+  }
+  size_ = count;
+}
+
+template <class T, GLenum target>
+void VertexBuffer<T, target>::RotateRing() {
+  // Fence the bound buffer object: the draws that read it have all been
+  // issued by now.
+  RingSlot retired{Release(), capacity_, 0};
+  GL_CHECK(retired.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+  RingSlot next = ring_.front();
+  ring_.erase(ring_.begin());
+  ring_.push_back(retired);
+  if (next.fence != 0) {
+    // With a few frames in between this is normally signaled already.
+    const GLuint64 kTimeoutNs = 1000000000;
+    GLenum status;
+    do {
+      GL_CHECK(status = glClientWaitSync(next.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                         kTimeoutNs));
+    } while (status == GL_TIMEOUT_EXPIRED);
+    GL_CHECK(glDeleteSync(next.fence));
+    if (status == GL_WAIT_FAILED)
+      throw std::runtime_error("Failed waiting for a streaming buffer fence!");
+  }
+  Reset(next.handle);
+  capacity_ = next.capacity;
 }
 }  // namespace GLOO
 
@@ -1,14 +1,615 @@
 #include "ObjParser.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <unordered_set>
 
+#include "gloo/MappedFile.hpp"
+#include "gloo/ThreadPool.hpp"
 #include "gloo/utils.hpp"
 
 namespace GLOO {
+namespace {
+// Helpers for tokenizing an OBJ file in place. Each works on the range
+// [p, end) of a single line and advances p past what it consumed.
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+const char* SkipSpaces(const char* p, const char* end) {
+  while (p < end && IsSpace(*p))
+    p++;
+  return p;
+}
+
+bool AtTokenEnd(const char* p, const char* end) {
+  return p == end || IsSpace(*p);
+}
+
+// Returns the next whitespace-separated token; empty at the end of the line.
+std::string ReadToken(const char*& p, const char* end) {
+  p = SkipSpaces(p, end);
+  const char* start = p;
+  while (p < end && !IsSpace(*p))
+    p++;
+  return std::string(start, p);
+}
+
+bool TokenEquals(const char* token, size_t length, const char* word) {
+  return length == strlen(word) && memcmp(token, word, length) == 0;
+}
+
+double Pow10(int exponent) {
+  // Powers of ten up to 1e22 are exact in a double.
+  static const double kExact[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  if (exponent >= 0 && exponent <= 22)
+    return kExact[exponent];
+  if (exponent < 0 && exponent >= -22)
+    return 1.0 / kExact[-exponent];
+  return std::pow(10.0, exponent);
+}
+
+// Parses a decimal number with optional sign, fraction and exponent, as
+// written by common exporters. Accurate to well within float precision.
+bool ParseFloat(const char*& p, const char* end, float& value) {
+  p = SkipSpaces(p, end);
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    p++;
+  }
+  // Up to 19 significant digits fit in the mantissa; later ones only move
+  // the decimal point.
+  uint64_t mantissa = 0;
+  int num_significant = 0;
+  int exponent = 0;
+  bool any_digit = false;
+  for (; p < end && IsDigit(*p); p++) {
+    any_digit = true;
+    if (num_significant < 19) {
+      mantissa = mantissa * 10 + uint64_t(*p - '0');
+      if (mantissa != 0)
+        num_significant++;
+    } else {
+      exponent++;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && IsDigit(*p); p++) {
+      any_digit = true;
+      if (num_significant < 19) {
+        mantissa = mantissa * 10 + uint64_t(*p - '0');
+        if (mantissa != 0)
+          num_significant++;
+        exponent--;
+      }
+    }
+  }
+  if (!any_digit)
+    return false;
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    p++;
+    bool negative_exponent = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negative_exponent = *p == '-';
+      p++;
+    }
+    if (p == end || !IsDigit(*p))
+      return false;
+    int e = 0;
+    for (; p < end && IsDigit(*p); p++) {
+      if (e < 10000)
+        e = e * 10 + (*p - '0');
+    }
+    exponent += negative_exponent ? -e : e;
+  }
+  double result = double(mantissa) * Pow10(exponent);
+  value = float(negative ? -result : result);
+  return true;
+}
+
+bool ParseInt(const char*& p, const char* end, long& value) {
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    p++;
+  }
+  if (p == end || !IsDigit(*p))
+    return false;
+  long result = 0;
+  for (; p < end && IsDigit(*p); p++) {
+    result = result * 10 + (*p - '0');
+  }
+  value = negative ? -result : result;
+  return true;
+}
+
+// Position, texture coordinate and normal indices of a face corner, 0-based;
+// -1 for those not given.
+struct FaceCorner {
+  int v;
+  int vt;
+  int vn;
+
+  bool operator==(const FaceCorner& other) const {
+    return v == other.v && vt == other.vt && vn == other.vn;
+  }
+};
+
+struct FaceCornerHash {
+  size_t operator()(const FaceCorner& c) const {
+    return size_t(c.v) * 73856093u ^ size_t(c.vt) * 19349663u ^
+           size_t(c.vn) * 83492791u;
+  }
+};
+
+// An element kind (position, texture coordinate or normal) as seen from one
+// chunk of the file. Face indices that refer to elements of earlier chunks
+// cannot be checked until the number of elements in those chunks is known,
+// so the chunk tracks the bounds its indices require of that number.
+struct ChunkElementCount {
+  // Elements defined in the chunk so far.
+  size_t count{0};
+  // Largest positive index (0-based) minus count at the time it was used;
+  // valid if below the number of elements in earlier chunks.
+  long long max_excess{std::numeric_limits<long long>::min()};
+  // Smallest negative index plus count at the time it was used; valid if
+  // the number of elements in earlier chunks is at least its negation.
+  long long min_relative{std::numeric_limits<long long>::max()};
+};
+
+// Things that affect groups, materials or messages, replayed in file order
+// once all chunks are parsed.
+struct ObjEvent {
+  enum class Type { Group, UseMaterial, MaterialLibrary, Unsupported };
+  Type type;
+  // Face corners in the chunk before the event.
+  size_t num_corners;
+  std::string name;
+};
+
+// Everything parsed from a range of whole lines of an OBJ file.
+struct ObjChunk {
+  PositionArray positions;
+  NormalArray normals;
+  TexCoordArray tex_coords;
+  // Corners of all faces, three per triangle. Positive indices are final;
+  // negative ones are stored relative to the first element of the chunk
+  // and listed in relative_fields.
+  std::vector<FaceCorner> corners;
+  std::vector<std::pair<size_t, int FaceCorner::*>> relative_fields;
+  ChunkElementCount position_count;
+  ChunkElementCount tex_coord_count;
+  ChunkElementCount normal_count;
+  std::vector<ObjEvent> events;
+  size_t num_lines{0};
+  // Line (within the chunk) that could not be parsed, or 0.
+  size_t error_line{0};
+};
+
+// Whether the indices of a chunk are in range given the number of elements
+// in earlier chunks.
+bool IndicesValid(const ChunkElementCount& element, size_t num_earlier) {
+  long long earlier = static_cast<long long>(num_earlier);
+  return element.max_excess < earlier &&
+         (element.min_relative == std::numeric_limits<long long>::max() ||
+          element.min_relative + earlier >= 0);
+}
+
+// Resolves one face index of a chunk. For the first chunk, where all
+// earlier elements are known, indices are checked right away.
+bool ResolveChunkIndex(long index,
+                       bool first_chunk,
+                       size_t corner,
+                       int FaceCorner::*field,
+                       ChunkElementCount& element,
+                       ObjChunk& chunk) {
+  long long local = static_cast<long long>(element.count);
+  long long resolved;
+  if (index > 0) {
+    resolved = index - 1;
+    element.max_excess = std::max(element.max_excess, resolved - local);
+  } else if (index < 0) {
+    resolved = local + index;
+    element.min_relative = std::min(element.min_relative, resolved);
+    chunk.relative_fields.emplace_back(corner, field);
+  } else {
+    return false;
+  }
+  if (first_chunk && (element.max_excess >= 0 || element.min_relative < 0))
+    return false;
+  if (resolved > std::numeric_limits<int>::max() ||
+      resolved < std::numeric_limits<int>::min())
+    return false;
+  chunk.corners[corner].*field = int(resolved);
+  return true;
+}
+
+// Indices of a face corner as written in the file; 0 for those not given.
+struct ObjCornerIndices {
+  long v;
+  long vt;
+  long vn;
+};
+
+// Parses one corner of an "f" line: v, v/vt, v//vn or v/vt/vn.
+bool ParseFaceCorner(const char*& p,
+                     const char* end,
+                     ObjCornerIndices& corner) {
+  corner.vt = corner.vn = 0;
+  if (!ParseInt(p, end, corner.v) || corner.v == 0)
+    return false;
+  if (p < end && *p == '/') {
+    p++;
+    if (p < end && *p != '/') {
+      if (!ParseInt(p, end, corner.vt) || corner.vt == 0)
+        return false;
+    }
+    if (p < end && *p == '/') {
+      p++;
+      if (!ParseInt(p, end, corner.vn) || corner.vn == 0)
+        return false;
+    }
+  }
+  return AtTokenEnd(p, end);
+}
+
+// Appends a corner with the given indices to the chunk.
+bool AddFaceCorner(const ObjCornerIndices& indices,
+                   bool first_chunk,
+                   ObjChunk& chunk) {
+  size_t corner = chunk.corners.size();
+  chunk.corners.push_back({-1, -1, -1});
+  if (!ResolveChunkIndex(indices.v, first_chunk, corner, &FaceCorner::v,
+                         chunk.position_count, chunk))
+    return false;
+  if (indices.vt != 0 &&
+      !ResolveChunkIndex(indices.vt, first_chunk, corner, &FaceCorner::vt,
+                         chunk.tex_coord_count, chunk))
+    return false;
+  if (indices.vn != 0 &&
+      !ResolveChunkIndex(indices.vn, first_chunk, corner, &FaceCorner::vn,
+                         chunk.normal_count, chunk))
+    return false;
+  return true;
+}
+
+// Parses the whole lines in [begin, end). Stops at the first malformed
+// line and records it in chunk.error_line.
+void ParseChunk(const char* begin,
+                const char* end,
+                bool first_chunk,
+                ObjChunk& chunk) {
+  // Each command is reported once per chunk, and once overall on replay.
+  std::unordered_set<std::string> unsupported_commands;
+  std::vector<ObjCornerIndices> polygon;
+  const char* p = begin;
+  while (p < end) {
+    const char* line_end =
+        static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+    if (line_end == nullptr)
+      line_end = end;
+    const char* next_line = line_end + 1;
+    chunk.num_lines++;
+
+    p = SkipSpaces(p, line_end);
+    const char* command = p;
+    while (p < line_end && !IsSpace(*p))
+      p++;
+    size_t command_length = size_t(p - command);
+
+    bool ok = true;
+    if (command_length == 0 || command[0] == '#') {
+      // Empty line or comment.
+    } else if (TokenEquals(command, command_length, "v")) {
+      glm::vec3 v;
+      ok = ParseFloat(p, line_end, v.x) && ParseFloat(p, line_end, v.y) &&
+           ParseFloat(p, line_end, v.z);
+      chunk.positions.push_back(v);
+      chunk.position_count.count++;
+    } else if (TokenEquals(command, command_length, "vn")) {
+      glm::vec3 n;
+      ok = ParseFloat(p, line_end, n.x) && ParseFloat(p, line_end, n.y) &&
+           ParseFloat(p, line_end, n.z);
+      chunk.normals.push_back(n);
+      chunk.normal_count.count++;
+    } else if (TokenEquals(command, command_length, "vt")) {
+      glm::vec2 uv;
+      ok = ParseFloat(p, line_end, uv.s) && ParseFloat(p, line_end, uv.t);
+      chunk.tex_coords.push_back(uv);
+      chunk.tex_coord_count.count++;
+    } else if (TokenEquals(command, command_length, "f")) {
+      polygon.clear();
+      for (p = SkipSpaces(p, line_end); ok && p < line_end;
+           p = SkipSpaces(p, line_end)) {
+        ObjCornerIndices corner;
+        ok = ParseFaceCorner(p, line_end, corner);
+        polygon.push_back(corner);
+      }
+      ok = ok && polygon.size() >= 3;
+      // Triangulate polygons as a fan around their first corner.
+      for (size_t i = 2; ok && i < polygon.size(); i++) {
+        ok = AddFaceCorner(polygon[0], first_chunk, chunk) &&
+             AddFaceCorner(polygon[i - 1], first_chunk, chunk) &&
+             AddFaceCorner(polygon[i], first_chunk, chunk);
+      }
+    } else if (TokenEquals(command, command_length, "g")) {
+      chunk.events.push_back({ObjEvent::Type::Group, chunk.corners.size(),
+                              ReadToken(p, line_end)});
+    } else if (TokenEquals(command, command_length, "usemtl")) {
+      chunk.events.push_back({ObjEvent::Type::UseMaterial,
+                              chunk.corners.size(), ReadToken(p, line_end)});
+    } else if (TokenEquals(command, command_length, "mtllib")) {
+      chunk.events.push_back({ObjEvent::Type::MaterialLibrary,
+                              chunk.corners.size(), ReadToken(p, line_end)});
+    } else {
+      std::string name(command, command_length);
+      if (unsupported_commands.insert(name).second) {
+        chunk.events.push_back(
+            {ObjEvent::Type::Unsupported, chunk.corners.size(), name});
+      }
+    }
+    if (!ok) {
+      chunk.error_line = chunk.num_lines;
+      return;
+    }
+    p = next_line;
+  }
+}
+
+// Moves the parsed elements into data. When every corner uses the same
+// index for its position, texture coordinate and normal (or gives only a
+// position), as in most exported meshes, the arrays are used as they are
+// and indexed by position. Otherwise each distinct combination of indices
+// becomes a vertex of its own.
+void BuildVertices(PositionArray& positions,
+                   TexCoordArray& tex_coords,
+                   NormalArray& normals,
+                   const std::vector<FaceCorner>& corners,
+                   ObjParser::ParsedData& data) {
+  bool shared_indices = true;
+  for (const FaceCorner& c : corners) {
+    if ((c.vt != -1 && c.vt != c.v) || (c.vn != -1 && c.vn != c.v)) {
+      shared_indices = false;
+      break;
+    }
+  }
+
+  if (!corners.empty())
+    data.indices = make_unique<IndexArray>();
+  if (shared_indices) {
+    if (!positions.empty())
+      data.positions = make_unique<PositionArray>(std::move(positions));
+    if (!normals.empty())
+      data.normals = make_unique<NormalArray>(std::move(normals));
+    if (!tex_coords.empty())
+      data.tex_coords = make_unique<TexCoordArray>(std::move(tex_coords));
+    if (data.indices != nullptr) {
+      data.indices->reserve(corners.size());
+      for (const FaceCorner& c : corners) {
+        data.indices->push_back(unsigned(c.v));
+      }
+    }
+    return;
+  }
+
+  data.positions = make_unique<PositionArray>();
+  if (!normals.empty())
+    data.normals = make_unique<NormalArray>();
+  if (!tex_coords.empty())
+    data.tex_coords = make_unique<TexCoordArray>();
+  data.indices->reserve(corners.size());
+  std::unordered_map<FaceCorner, unsigned, FaceCornerHash> vertex_ids;
+  for (const FaceCorner& c : corners) {
+    auto inserted =
+        vertex_ids.emplace(c, unsigned(data.positions->size()));
+    if (inserted.second) {
+      data.positions->push_back(positions[c.v]);
+      // Corners without a normal or texture coordinate get zeros.
+      if (data.normals != nullptr)
+        data.normals->push_back(c.vn >= 0 ? normals[c.vn] : glm::vec3(0.f));
+      if (data.tex_coords != nullptr)
+        data.tex_coords->push_back(c.vt >= 0 ? tex_coords[c.vt]
+                                             : glm::vec2(0.f));
+    }
+    data.indices->push_back(inserted.first->second);
+  }
+}
+}  // namespace
+
 ObjParser::ParsedData ObjParser::Parse(const std::string& file_path,
-                                       bool& success) {
+                                       bool& success,
+                                       ParseMode mode) {
+  if (mode == ParseMode::Legacy)
+    return ParseLegacy(file_path, success);
+  success = false;
+  MappedFile file;
+  if (!file.Open(file_path)) {
+    std::cerr << "ERROR: Unable to open OBJ file " + file_path + "!"
+              << std::endl;
+    return {};
+  }
+  const char* file_begin = file.GetData();
+  const char* file_end = file_begin + file.GetSize();
+
+  // Split at line boundaries into chunks of at least kMinChunkSize bytes,
+  // a few per thread so that uneven chunks balance out.
+  std::vector<const char*> bounds = {file_begin};
+  size_t num_threads = ThreadPool::GetInstance().GetNumThreads();
+  if (mode == ParseMode::Parallel && num_threads > 1) {
+    const size_t kMinChunkSize = 1 << 20;
+    size_t num_chunks =
+        std::min(file.GetSize() / kMinChunkSize, 4 * num_threads);
+    for (size_t i = 1; i < num_chunks; i++) {
+      const char* p = std::max(bounds.back(),
+                               file_begin + file.GetSize() * i / num_chunks);
+      p = static_cast<const char*>(memchr(p, '\n', size_t(file_end - p)));
+      if (p == nullptr)
+        break;
+      bounds.push_back(p + 1);
+    }
+  }
+  bounds.push_back(file_end);
+
+  std::vector<ObjChunk> chunks(bounds.size() - 1);
+  ThreadPool::GetInstance().ParallelFor(
+      chunks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          ParseChunk(bounds[i], bounds[i + 1], i == 0, chunks[i]);
+        }
+      });
+
+  // Offsets of each chunk's elements in the whole file.
+  struct ChunkOffsets {
+    size_t positions;
+    size_t tex_coords;
+    size_t normals;
+    size_t corners;
+    size_t lines;
+  };
+  std::vector<ChunkOffsets> offsets(chunks.size() + 1);
+  offsets[0] = {0, 0, 0, 0, 0};
+  for (size_t i = 0; i < chunks.size(); i++) {
+    const ObjChunk& chunk = chunks[i];
+    ChunkOffsets& o = offsets[i];
+    // The first chunk checked its indices while parsing.
+    bool indices_valid =
+        i == 0 || (IndicesValid(chunk.position_count, o.positions) &&
+                   IndicesValid(chunk.tex_coord_count, o.tex_coords) &&
+                   IndicesValid(chunk.normal_count, o.normals));
+    if (!indices_valid) {
+      // Some index refers to an element not defined before it. Parse the
+      // file again in one piece, which finds the line.
+      return Parse(file_path, success, ParseMode::Sequential);
+    }
+    if (chunk.error_line != 0) {
+      std::cerr << "ERROR: Malformed line " << o.lines + chunk.error_line
+                << " in OBJ file " << file_path << "!" << std::endl;
+      return {};
+    }
+    offsets[i + 1] = {o.positions + chunk.positions.size(),
+                      o.tex_coords + chunk.tex_coords.size(),
+                      o.normals + chunk.normals.size(),
+                      o.corners + chunk.corners.size(),
+                      o.lines + chunk.num_lines};
+  }
+
+  // Stitch the chunks together.
+  PositionArray positions;
+  NormalArray normals;
+  TexCoordArray tex_coords;
+  std::vector<FaceCorner> corners;
+  if (chunks.size() == 1) {
+    positions = std::move(chunks[0].positions);
+    normals = std::move(chunks[0].normals);
+    tex_coords = std::move(chunks[0].tex_coords);
+    corners = std::move(chunks[0].corners);
+  } else {
+    const ChunkOffsets& total = offsets.back();
+    positions.resize(total.positions);
+    normals.resize(total.normals);
+    tex_coords.resize(total.tex_coords);
+    corners.resize(total.corners);
+    ThreadPool::GetInstance().ParallelFor(
+        chunks.size(), 1, [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; i++) {
+            ObjChunk& chunk = chunks[i];
+            const ChunkOffsets& o = offsets[i];
+            std::copy(chunk.positions.begin(), chunk.positions.end(),
+                      positions.begin() + o.positions);
+            std::copy(chunk.normals.begin(), chunk.normals.end(),
+                      normals.begin() + o.normals);
+            std::copy(chunk.tex_coords.begin(), chunk.tex_coords.end(),
+                      tex_coords.begin() + o.tex_coords);
+            std::copy(chunk.corners.begin(), chunk.corners.end(),
+                      corners.begin() + o.corners);
+            for (const auto& rel : chunk.relative_fields) {
+              FaceCorner& corner = corners[o.corners + rel.first];
+              if (rel.second == &FaceCorner::v)
+                corner.v += int(o.positions);
+              else if (rel.second == &FaceCorner::vt)
+                corner.vt += int(o.tex_coords);
+              else
+                corner.vn += int(o.normals);
+            }
+            // Free the arrays of each chunk as soon as they are copied.
+            PositionArray().swap(chunk.positions);
+            NormalArray().swap(chunk.normals);
+            TexCoordArray().swap(chunk.tex_coords);
+            std::vector<FaceCorner>().swap(chunk.corners);
+          }
+        });
+  }
+
+  // Replay group, material and message events in file order.
+  std::string base_path = GetBasePath(file_path);
+  ParsedData data;
+  MaterialDict material_dict;
+  MeshGroup current_group;
+  std::unordered_set<std::string> reported_commands;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    for (const ObjEvent& event : chunks[i].events) {
+      size_t num_corners = offsets[i].corners + event.num_corners;
+      switch (event.type) {
+        case ObjEvent::Type::Group:
+          if (current_group.name != "") {
+            current_group.num_indices =
+                num_corners - current_group.start_face_index;
+            data.groups.push_back(std::move(current_group));
+          }
+          current_group.name = event.name;
+          current_group.start_face_index = num_corners;
+          break;
+        case ObjEvent::Type::UseMaterial:
+          current_group.material_name = event.name;
+          break;
+        case ObjEvent::Type::MaterialLibrary:
+          material_dict = ParseMTL(base_path + event.name);
+          break;
+        case ObjEvent::Type::Unsupported:
+          if (reported_commands.insert(event.name).second) {
+            if (event.name == "o" || event.name == "s")
+              std::cout << "Skipped command: " << event.name << std::endl;
+            else
+              std::cerr << "Unknown obj command: " << event.name
+                        << std::endl;
+          }
+          break;
+      }
+    }
+  }
+
+  if (current_group.name != "") {
+    current_group.num_indices = corners.size() - current_group.start_face_index;
+    data.groups.push_back(std::move(current_group));
+  }
+
+  // Associate materials.
+  for (auto& g : data.groups) {
+    auto itr = material_dict.find(g.material_name);
+    if (itr != material_dict.end())
+      g.material = itr->second;
+  }
+
+  BuildVertices(positions, tex_coords, normals, corners, data);
+  success = true;
+  return data;
+}
+
+ObjParser::ParsedData ObjParser::ParseLegacy(const std::string& file_path,
+                                             bool& success) {
   success = false;
   std::fstream fs(file_path);
   if (!fs) {
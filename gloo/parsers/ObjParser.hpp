@@ -20,12 +20,27 @@ class ObjParser {
     std::vector<MeshGroup> groups;
   };
 
-  static ParsedData Parse(const std::string& file_path, bool& success);
+  enum class ParseMode {
+    Sequential,
+    // Splits the file at line boundaries and parses the pieces on the
+    // ThreadPool. The result is identical to a sequential parse.
+    Parallel,
+    // Reads the file line by line through std::getline and a stringstream,
+    // as the parser did before it worked in place. It only reads the first
+    // three position indices of each face. Kept as a baseline for
+    // bench/ObjParserBench.cpp.
+    Legacy,
+  };
+
+  static ParsedData Parse(const std::string& file_path,
+                          bool& success,
+                          ParseMode mode = ParseMode::Sequential);
 
  private:
   using MaterialDict =
       std::unordered_map<std::string, std::shared_ptr<Material>>;
 
+  static ParsedData ParseLegacy(const std::string& file_path, bool& success);
   static MaterialDict ParseMTL(const std::string& file_path);
 };
 }  // namespace GLOO
@@ -5,117 +5,59 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/matrix.hpp>
 
-#include "gloo/components/CameraComponent.hpp"
-#include "gloo/components/LightComponent.hpp"
 #include "gloo/components/RenderingComponent.hpp"
-#include "gloo/components/MaterialComponent.hpp"
+#include "gloo/Material.hpp"
 #include "gloo/SceneNode.hpp"
-#include "gloo/lights/AmbientLight.hpp"
-#include "gloo/lights/PointLight.hpp"
-#include "glm/gtx/string_cast.hpp"
-
-#include "gloo/lights/DirectionalLight.hpp"
 
 namespace GLOO {
 PhongShader::PhongShader()
     : ShaderProgram(std::unordered_map<GLenum, std::string>{
           {GL_VERTEX_SHADER, "phong.vert"},
           {GL_FRAGMENT_SHADER, "phong.frag"}}) {
+  model_matrix_location_ = GetUniformLocation("model_matrix");
+  normal_matrix_location_ = GetUniformLocation("normal_matrix");
+  material_ambient_location_ = GetUniformLocation("material.ambient");
+  material_diffuse_location_ = GetUniformLocation("material.diffuse");
+  material_specular_location_ = GetUniformLocation("material.specular");
+  material_shininess_location_ = GetUniformLocation("material.shininess");
+  light_index_location_ = GetUniformLocation("light_index");
 }
 
-void PhongShader::AssociateVertexArray(VertexArray& vertex_array) const {
+void PhongShader::CheckVertexArray(const VertexArray& vertex_array) const {
   if (!vertex_array.HasPositionBuffer()) {
     throw std::runtime_error("Phong shader requires vertex positions!");
   }
   if (!vertex_array.HasNormalBuffer()) {
     throw std::runtime_error("Phong shader requires vertex normals!");
   }
-  vertex_array.LinkPositionBuffer(GetAttributeLocation("vertex_position"));
-  vertex_array.LinkNormalBuffer(GetAttributeLocation("vertex_normal"));
-  if (vertex_array.HasTexCoordBuffer()) {
-    GLint loc = GetAttributeLocation("vertex_tex_coord");
-    if (loc != -1) {
-      vertex_array.LinkTexCoordBuffer(loc);
-    }
-  }
 }
 
 void PhongShader::SetTargetNode(const SceneNode& node,
                                 const glm::mat4& model_matrix) const {
-  // Associate the right VAO before rendering.
-  AssociateVertexArray(node.GetComponentPtr<RenderingComponent>()
-                           ->GetVertexObjectPtr()
-                           ->GetVertexArray());
+  // Make sure the VAO has the attributes this shader reads.
+  CheckVertexArray(node.GetComponentPtr<RenderingComponent>()
+                       ->GetVertexObjectPtr()
+                       ->GetVertexArray());
 
   // Set transform.
-  glm::mat3 normal_matrix =
-      glm::transpose(glm::inverse(glm::mat3(model_matrix)));
-  SetUniform("model_matrix", model_matrix);
-  SetUniform("normal_matrix", normal_matrix);
-
-  // Set material.
-  MaterialComponent* material_component_ptr =
-      node.GetComponentPtr<MaterialComponent>();
-  const Material* material_ptr;
-  if (material_component_ptr == nullptr) {
-    material_ptr = &Material::GetDefault();
-  } else {
-    material_ptr = &material_component_ptr->GetMaterial();
-  }
-  SetUniform("material.ambient", material_ptr->GetAmbientColor());
-  SetUniform("material.diffuse", material_ptr->GetDiffuseColor());
-  SetUniform("material.specular", material_ptr->GetSpecularColor());
-  SetUniform("material.shininess", material_ptr->GetShininess());
-
+  SetUniform(model_matrix_location_, model_matrix);
+  // Cached by the node's transform along with its world matrix.
+  SetUniform(normal_matrix_location_,
+             node.GetTransform().GetLocalToWorldNormalMatrix());
 }
 
-void PhongShader::SetCamera(const CameraComponent& camera) const {
-  SetUniform("view_matrix", camera.GetViewMatrix());
-  SetUniform("projection_matrix", camera.GetProjectionMatrix());
-  SetUniform("camera_position",
-             glm::vec3(glm::inverse(camera.GetViewMatrix()) * glm::vec4(0.f,0.f,0.f,1.f)));
-  // camera position should take into account position, direction, and distance
-  // could probably rotate (1, 0, 0, 1) homogeneous to get the camera diretion
-  // std::cout << glm::to_string(camera.GetNodePtr()->GetTransform().GetWorldPosition()) << std::endl;
-}
-
-void PhongShader::SetLightSource(const LightComponent& component) const {
-  auto light_ptr = component.GetLightPtr();
-  if (light_ptr == nullptr) {
-    throw std::runtime_error("Light component has no light attached!");
+void PhongShader::SetMaterial(const Material* material) const {
+  if (material == nullptr) {
+    material = &Material::GetDefault();
   }
+  SetUniform(material_ambient_location_, material->GetAmbientColor());
+  SetUniform(material_diffuse_location_, material->GetDiffuseColor());
+  SetUniform(material_specular_location_, material->GetSpecularColor());
+  SetUniform(material_shininess_location_, material->GetShininess());
+}
 
-  // First disable all lights.
-  // In a single rendering pass, only one light of one type is enabled.
-  SetUniform("ambient_light.enabled", false);
-  SetUniform("point_light.enabled", false);
-  SetUniform("directional_light.enabled", false);
-
-  if (light_ptr->GetType() == LightType::Ambient) {
-    auto ambient_light_ptr = static_cast<AmbientLight*>(light_ptr);
-    SetUniform("ambient_light.enabled", true);
-    SetUniform("ambient_light.ambient", ambient_light_ptr->GetAmbientColor());
-  } else if (light_ptr->GetType() == LightType::Point) {
-    auto point_light_ptr = static_cast<PointLight*>(light_ptr);
-    SetUniform("point_light.enabled", true);
-    SetUniform("point_light.position",
-               component.GetNodePtr()->GetTransform().GetPosition());
-    SetUniform("point_light.diffuse", point_light_ptr->GetDiffuseColor());
-    SetUniform("point_light.specular", point_light_ptr->GetSpecularColor());
-    SetUniform("point_light.attenuation", point_light_ptr->GetAttenuation());
-  } else if (light_ptr->GetType() == LightType::Directional) {
-    auto directional_light_ptr = static_cast<DirectionalLight*>(light_ptr);
-    SetUniform("directional_light.enabled", true);
-    SetUniform("directional_light.direction",
-               directional_light_ptr->GetDirection());
-    SetUniform("directional_light.diffuse",
-               directional_light_ptr->GetDiffuseColor());
-    SetUniform("directional_light.specular",
-               directional_light_ptr->GetSpecularColor());
-  } else {
-    throw std::runtime_error(
-        "Encountered light type unrecognized by the shader!");
-  }
+void PhongShader::SetLightIndex(int light_index) const {
+  SetUniform(light_index_location_, light_index);
 }
 
 }  // namespace GLOO
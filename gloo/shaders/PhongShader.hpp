@@ -9,12 +9,20 @@ class PhongShader : public ShaderProgram {
   PhongShader();
   void SetTargetNode(const SceneNode& node,
                      const glm::mat4& model_matrix) const override;
-  void SetCamera(const CameraComponent& camera) const override;
-  void SetLightSource(const LightComponent& componentt) const override;
+  void SetMaterial(const Material* material) const override;
+  void SetLightIndex(int light_index) const override;
 
 
  private:
-  void AssociateVertexArray(VertexArray& vertex_array) const;
+  void CheckVertexArray(const VertexArray& vertex_array) const;
+
+  GLint model_matrix_location_;
+  GLint normal_matrix_location_;
+  GLint material_ambient_location_;
+  GLint material_diffuse_location_;
+  GLint material_specular_location_;
+  GLint material_shininess_location_;
+  GLint light_index_location_;
 };
 }  // namespace GLOO
 
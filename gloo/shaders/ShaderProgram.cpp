@@ -1,14 +1,17 @@
 #include "ShaderProgram.hpp"
 
+#include <algorithm>
 #include <iterator>
 #include <stdexcept>
 #include <unordered_map>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include <glm/gtc/type_ptr.hpp>
 
 #include <gloo/utils.hpp>
+#include "UniformBlocks.hpp"
 
 namespace GLOO {
 ShaderProgram::ShaderProgram(
@@ -46,6 +49,48 @@ ShaderProgram::ShaderProgram(
     GL_CHECK(glDetachShader(shader_program_, handle));
     GL_CHECK(glDeleteShader(handle));
   }
+
+  CacheUniformLocations();
+  BindUniformBlocks();
+}
+
+void ShaderProgram::CacheUniformLocations() {
+  GLint num_uniforms;
+  GLint max_name_length;
+  GL_CHECK(glGetProgramiv(shader_program_, GL_ACTIVE_UNIFORMS, &num_uniforms));
+  GL_CHECK(glGetProgramiv(shader_program_, GL_ACTIVE_UNIFORM_MAX_LENGTH,
+                          &max_name_length));
+  std::vector<GLchar> name_buf(std::max(max_name_length, 1));
+  for (GLint i = 0; i < num_uniforms; i++) {
+    GLsizei name_length;
+    GLint size;
+    GLenum type;
+    GL_CHECK(glGetActiveUniform(shader_program_, GLuint(i),
+                                GLsizei(name_buf.size()), &name_length, &size,
+                                &type, name_buf.data()));
+    std::string name(name_buf.data(), name_length);
+    GLint loc = glGetUniformLocation(shader_program_, name.c_str());
+    GL_CHECK_ERROR();
+    if (loc == -1)
+      continue;
+    uniform_locations_[name] = loc;
+    // Arrays are reported as "name[0]"; also accept the bare name.
+    auto bracket = name.find("[0]");
+    if (bracket != std::string::npos && bracket + 3 == name.size())
+      uniform_locations_[name.substr(0, bracket)] = loc;
+  }
+}
+
+void ShaderProgram::BindUniformBlocks() {
+  const std::pair<const char*, GLuint> blocks[] = {
+      {kCameraBlockName, kCameraBlockBinding},
+      {kLightBlockName, kLightBlockBinding}};
+  for (auto& block : blocks) {
+    GLuint index = glGetUniformBlockIndex(shader_program_, block.first);
+    GL_CHECK_ERROR();
+    if (index != GL_INVALID_INDEX)
+      GL_CHECK(glUniformBlockBinding(shader_program_, index, block.second));
+  }
 }
 
 ShaderProgram::~ShaderProgram() {
@@ -66,6 +111,11 @@ GLint ShaderProgram::GetAttributeLocation(const std::string& name) const {
   return loc;
 }
 
+GLint ShaderProgram::GetUniformLocation(const std::string& name) const {
+  auto itr = uniform_locations_.find(name);
+  return itr == uniform_locations_.end() ? -1 : itr->second;
+}
+
 GLuint ShaderProgram::LoadShader(GLenum type,
                                  std::string shader_code,
                                  const std::string& shader_file_name) {
@@ -101,34 +151,44 @@ GLuint ShaderProgram::LoadShader(GLenum type,
 
 void ShaderProgram::SetUniform(const std::string& name,
                                const glm::mat4& value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value)));
+  SetUniform(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetUniform(const std::string& name,
                                const glm::mat3& value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(value)));
+  SetUniform(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetUniform(const std::string& name,
                                const glm::vec3& value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniform3fv(loc, 1, glm::value_ptr(value)));
+  SetUniform(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetUniform(const std::string& name, float value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniform1f(loc, value));
+  SetUniform(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetUniform(const std::string& name, int value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniform1i(loc, value));
+  SetUniform(GetUniformLocation(name), value);
+}
+
+void ShaderProgram::SetUniform(GLint location, const glm::mat4& value) const {
+  GL_CHECK(glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)));
+}
+
+void ShaderProgram::SetUniform(GLint location, const glm::mat3& value) const {
+  GL_CHECK(glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)));
+}
+
+void ShaderProgram::SetUniform(GLint location, const glm::vec3& value) const {
+  GL_CHECK(glUniform3fv(location, 1, glm::value_ptr(value)));
+}
+
+void ShaderProgram::SetUniform(GLint location, float value) const {
+  GL_CHECK(glUniform1f(location, value));
+}
+
+void ShaderProgram::SetUniform(GLint location, int value) const {
+  GL_CHECK(glUniform1i(location, value));
 }
 }  // namespace GLOO
@@ -12,8 +12,7 @@
 #include "gloo/Transform.hpp"
 
 namespace GLOO {
-class CameraComponent;
-class LightComponent;
+class Material;
 class SceneNode;
 
 class ShaderProgram : public IBindable {
@@ -23,15 +22,29 @@ class ShaderProgram : public IBindable {
   virtual ~ShaderProgram();
   void Bind() const override;
   void Unbind() const override;
+  GLuint GetHandle() const {
+    return shader_program_;
+  }
   GLint GetAttributeLocation(const std::string& name) const;
+  // Location of an active uniform, or -1 if the program has no such uniform
+  // (or it lives in a uniform block). Locations are looked up once when the
+  // program is linked.
+  GLint GetUniformLocation(const std::string& name) const;
 
   // The following Set* methods are called by the renderer, thus const.
   virtual void SetTargetNode(const SceneNode& node,
                              const glm::mat4& local_to_world_mat) const {
   }
-  virtual void SetCamera(const CameraComponent& camera) const {
+  // material is nullptr for nodes without a MaterialComponent. Set
+  // separately from SetTargetNode so that the renderer can skip it when
+  // consecutive draws share a material.
+  virtual void SetMaterial(const Material* material) const {
   }
-  virtual void SetLightSource(const LightComponent& light) const {
+  // The camera and the lights reach shaders through the uniform blocks in
+  // UniformBlocks.hpp, which the renderer uploads once per frame. A lighting
+  // pass only selects which entry of the light block to shade with, or
+  // kAllLights to shade with all of them at once.
+  virtual void SetLightIndex(int light_index) const {
   }
 
  protected:
@@ -41,15 +54,25 @@ class ShaderProgram : public IBindable {
   void SetUniform(const std::string& name, const glm::vec3& value) const;
   void SetUniform(const std::string& name, float value) const;
   void SetUniform(const std::string& name, int value) const;
+  // Same as above by location, for subclasses that keep the locations of
+  // the uniforms they set on every draw. Location -1 is ignored.
+  void SetUniform(GLint location, const glm::mat4& value) const;
+  void SetUniform(GLint location, const glm::mat3& value) const;
+  void SetUniform(GLint location, const glm::vec3& value) const;
+  void SetUniform(GLint location, float value) const;
+  void SetUniform(GLint location, int value) const;
 
  private:
   static GLuint LoadShader(GLenum type,
                            std::string shader_code,
                            const std::string& shader_filename);
+  void CacheUniformLocations();
+  void BindUniformBlocks();
 
   const static int kErrorLogBufferSize = 512;
 
   std::unordered_map<GLenum, GLuint> shader_handles_;
+  std::unordered_map<std::string, GLint> uniform_locations_;
   GLuint shader_program_;
 };
 }  // namespace GLOO
@@ -10,10 +10,13 @@ class SimpleShader : public ShaderProgram {
   SimpleShader();
   void SetTargetNode(const SceneNode& node,
                      const glm::mat4& model_matrix) const override;
-  void SetCamera(const CameraComponent& camera) const override;
+  void SetMaterial(const Material* material) const override;
 
  private:
-  void AssociateVertexArray(VertexArray& vertex_array) const;
+  void CheckVertexArray(const VertexArray& vertex_array) const;
+
+  GLint model_matrix_location_;
+  GLint material_color_location_;
 };
 }  // namespace GLOO
 
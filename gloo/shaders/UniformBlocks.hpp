@@ -0,0 +1,81 @@
+#ifndef GLOO_UNIFORM_BLOCKS_H_
+#define GLOO_UNIFORM_BLOCKS_H_
+
+#include <glm/glm.hpp>
+
+namespace GLOO {
+// Per-frame data shared by all shaders through std140 uniform blocks. The
+// renderer uploads each block once per frame; programs that declare a block
+// with one of these names get it bound to the matching binding point when
+// they are linked. The structs mirror the GLSL declarations in the shaders,
+// so both sides must be changed together.
+
+// layout(std140) uniform CameraBlock {
+//     mat4 view_matrix;
+//     mat4 projection_matrix;
+//     vec3 camera_position;
+// };
+const char* const kCameraBlockName = "CameraBlock";
+const unsigned int kCameraBlockBinding = 0;
+
+struct CameraBlock {
+  glm::mat4 view_matrix;
+  glm::mat4 projection_matrix;
+  glm::vec3 camera_position;
+  float padding;
+};
+
+// #define MAX_LIGHTS 8
+// struct Light {
+//     int type;
+//     vec3 position;
+//     vec3 direction;
+//     vec3 ambient;
+//     vec3 diffuse;
+//     vec3 specular;
+//     vec3 attenuation;
+// };
+// layout(std140) uniform LightBlock {
+//     Light lights[MAX_LIGHTS];
+//     int num_lights;
+// };
+const char* const kLightBlockName = "LightBlock";
+const unsigned int kLightBlockBinding = 1;
+// Lights beyond this many are ignored.
+const int kMaxLights = 8;
+// Light index that makes lighting shaders sum over all lights of the block.
+const int kAllLights = -1;
+
+struct LightBlockEntry {
+  // A LightType.
+  int type;
+  float padding0[3];
+  glm::vec3 position;
+  float padding1;
+  glm::vec3 direction;
+  float padding2;
+  glm::vec3 ambient;
+  float padding3;
+  glm::vec3 diffuse;
+  float padding4;
+  glm::vec3 specular;
+  float padding5;
+  // (constant, linear, quadratic)
+  glm::vec3 attenuation;
+  float padding6;
+};
+
+struct LightBlock {
+  LightBlockEntry lights[kMaxLights];
+  int num_lights;
+  float padding[3];
+};
+
+static_assert(sizeof(CameraBlock) == 144, "CameraBlock must match std140.");
+static_assert(sizeof(LightBlockEntry) == 112,
+              "LightBlockEntry must match std140.");
+static_assert(sizeof(LightBlock) == kMaxLights * 112 + 16,
+              "LightBlock must match std140.");
+}  // namespace GLOO
+
+#endif
@@ -2,24 +2,20 @@
 
 out vec4 frag_color;
 
-struct AmbientLight {
-    bool enabled;
-    vec3 ambient;
-};
-
-struct PointLight {
-    bool enabled;
+// Must match UniformBlocks.hpp.
+#define MAX_LIGHTS 8
+#define AMBIENT_LIGHT 0
+#define POINT_LIGHT 1
+#define DIRECTIONAL_LIGHT 2
+
+struct Light {
+    int type;
     vec3 position;
-    vec3 diffuse;
-    vec3 specular;
-    vec3 attenuation;
-};
-
-struct DirectionalLight {
-    bool enabled;
     vec3 direction;
+    vec3 ambient;
     vec3 diffuse;
     vec3 specular;
+    vec3 attenuation;
 };
 struct Material {
     vec3 ambient;
@@ -33,32 +29,38 @@ in vec3 world_normal;
 in vec4 color;
 in vec2 tex_coord;
 
-uniform vec3 camera_position;
+layout(std140) uniform CameraBlock {
+    mat4 view_matrix;
+    mat4 projection_matrix;
+    vec3 camera_position;
+};
+
+layout(std140) uniform LightBlock {
+    Light lights[MAX_LIGHTS];
+    int num_lights;
+};
 
 uniform Material material; // material properties of the object
-uniform AmbientLight ambient_light;
-uniform PointLight point_light; 
-uniform DirectionalLight directional_light;
-vec3 CalcAmbientLight();
-vec3 CalcPointLight(vec3 normal, vec3 view_dir);
-vec3 CalcDirectionalLight(vec3 normal, vec3 view_dir);
+// Light of the current lighting pass, or -1 to shade with all of them in
+// a single pass.
+uniform int light_index;
+vec3 CalcLight(Light light, vec3 normal, vec3 view_dir);
 
 void main() {
     vec3 normal = normalize(world_normal);
     vec3 view_dir = normalize(camera_position - world_position);
 
-    frag_color = color;
-
-    if (ambient_light.enabled) {
-        frag_color += vec4(CalcAmbientLight(), 1.0);
-    }
-    
-    if (point_light.enabled) {
-        frag_color += vec4(CalcPointLight(normal, view_dir), 1.0);
-    }
-
-    if (directional_light.enabled) {
-        frag_color += vec4(CalcDirectionalLight(normal, view_dir), 1.0);
+    // Each lighting pass adds the vertex color once, so a single pass adds
+    // it once per light to give the same result.
+    if (light_index < 0) {
+        frag_color = vec4(0.0);
+        for (int i = 0; i < num_lights; i++) {
+            frag_color += color;
+            frag_color += vec4(CalcLight(lights[i], normal, view_dir), 1.0);
+        }
+    } else {
+        frag_color = color;
+        frag_color += vec4(CalcLight(lights[light_index], normal, view_dir), 1.0);
     }
 }
 
@@ -74,12 +76,11 @@ vec3 GetSpecularColor() {
     return material.specular;
 }
 
-vec3 CalcAmbientLight() {
-    return ambient_light.ambient * GetAmbientColor();
+vec3 CalcAmbientLight(Light light) {
+    return light.ambient * GetAmbientColor();
 }
 
-vec3 CalcPointLight(vec3 normal, vec3 view_dir) {
-    PointLight light = point_light;
+vec3 CalcPointLight(Light light, vec3 normal, vec3 view_dir) {
     vec3 light_dir = normalize(light.position - world_position);
 
     float diffuse_intensity = max(dot(normal, light_dir), 0.0);
@@ -99,8 +100,7 @@ vec3 CalcPointLight(vec3 normal, vec3 view_dir) {
     return attenuation * (diffuse_color + specular_color);
 }
 
-vec3 CalcDirectionalLight(vec3 normal, vec3 view_dir) {
-    DirectionalLight light = directional_light;
+vec3 CalcDirectionalLight(Light light, vec3 normal, vec3 view_dir) {
     vec3 light_dir = normalize(-light.direction);
     float diffuse_intensity = max(dot(normal, light_dir), 0.0);
     vec3 diffuse_color = diffuse_intensity * light.diffuse * GetDiffuseColor();
@@ -115,3 +115,13 @@ vec3 CalcDirectionalLight(vec3 normal, vec3 view_dir) {
     return final_color;
 }
 
+vec3 CalcLight(Light light, vec3 normal, vec3 view_dir) {
+    if (light.type == AMBIENT_LIGHT) {
+        return CalcAmbientLight(light);
+    } else if (light.type == POINT_LIGHT) {
+        return CalcPointLight(light, normal, view_dir);
+    } else if (light.type == DIRECTIONAL_LIGHT) {
+        return CalcDirectionalLight(light, normal, view_dir);
+    }
+    return vec3(0.0);
+}
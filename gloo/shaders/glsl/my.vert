@@ -2,8 +2,11 @@
 
 uniform mat4 model_matrix;
 uniform mat3 normal_matrix;
-uniform mat4 view_matrix;
-uniform mat4 projection_matrix;
+layout(std140) uniform CameraBlock {
+    mat4 view_matrix;
+    mat4 projection_matrix;
+    vec3 camera_position;
+};
 
 layout(location = 0) in vec3 vertex_position;
 layout(location = 1) in vec3 vertex_normal;
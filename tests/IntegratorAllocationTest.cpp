@@ -0,0 +1,138 @@
+// Checks that stepping the fragment simulation does not touch the heap once
+// the integrator workspace and the system's scratch buffers have been sized.
+// Every allocation of the process goes through the replaced global operator
+// new below, including the aligned state buffers and the worker threads of
+// the ThreadPool.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ExplodingSystem.hpp"
+#include "FragmentGeometry.hpp"
+#include "FragmentState.hpp"
+#include "IntegratorFactory.hpp"
+#include "gloo/ThreadPool.hpp"
+
+namespace {
+std::atomic<size_t> num_allocations(0);
+}  // namespace
+
+void* operator new(size_t size) {
+  num_allocations++;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  num_allocations++;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+  return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+using namespace GLOO;
+
+namespace {
+const int kWarmupSteps = 10;
+const int kCheckedSteps = 20;
+const float kStep = 0.01f;
+
+// A shell of small triangles around the origin, like a coarse bunny.
+std::vector<glm::vec3> MakeTriangles(int rings, int segments) {
+  std::vector<glm::vec3> vertices;
+  const float kRadius = 0.1f;
+  const float kSize = 0.01f;
+  for (int i = 1; i < rings; i++) {
+    float theta = kPi * float(i) / float(rings);
+    for (int j = 0; j < segments; j++) {
+      float phi = 2.f * kPi * float(j) / float(segments);
+      glm::vec3 center =
+          kRadius * glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta),
+                              std::sin(theta) * std::sin(phi));
+      vertices.push_back(center + glm::vec3(kSize, 0.f, 0.f));
+      vertices.push_back(center + glm::vec3(0.f, kSize, 0.f));
+      vertices.push_back(center + glm::vec3(0.f, 0.f, kSize));
+    }
+  }
+  return vertices;
+}
+
+// Steps the fragments through an explosion with the given integrator and
+// returns the number of allocations made after the warm-up steps.
+size_t CountSteadyStateAllocations(IntegratorType type) {
+  FragmentState state;
+  auto geometry = std::make_shared<FragmentGeometry>(
+      FragmentGeometry::FromTriangles(MakeTriangles(40, 80), state));
+  ExplodingSystem system;
+  system.SetGeometry(geometry);
+  // Two overlapping blasts, both still pushing when the checked steps end.
+  system.AddBomb(0.f, glm::vec3(0.f), 1.f);
+  system.AddBomb(0.02f, glm::vec3(0.05f, 0.f, 0.f), 0.5f);
+  auto integrator =
+      IntegratorFactory::CreateIntegrator<FragmentSystemBase, FragmentState>(
+          type);
+  IntegratorWorkspace<FragmentState> workspace;
+
+  float time = 0.f;
+  size_t allocations = 0;
+  for (int i = 0; i < kWarmupSteps + kCheckedSteps; i++) {
+    if (i == kWarmupSteps)
+      allocations = num_allocations;
+    integrator->Integrate(system, state, time, kStep, workspace);
+    state.NormalizeOrientations();
+    time += kStep;
+  }
+  return num_allocations - allocations;
+}
+}  // namespace
+
+int main() {
+  // Start the pool before counting; its threads are created once.
+  ThreadPool::GetInstance();
+
+  const struct {
+    IntegratorType type;
+    const char* name;
+  } kIntegrators[] = {{IntegratorType::RK4, "RK4"},
+                      {IntegratorType::DormandPrince45, "DormandPrince45"},
+                      {IntegratorType::SymplecticEuler, "SymplecticEuler"},
+                      {IntegratorType::VelocityVerlet, "VelocityVerlet"}};
+  int failures = 0;
+  for (const auto& integrator : kIntegrators) {
+    size_t allocations = CountSteadyStateAllocations(integrator.type);
+    std::printf("%s: %zu allocations in %d steady-state steps\n",
+                integrator.name, allocations, kCheckedSteps);
+    if (allocations != 0)
+      failures++;
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,152 @@
+// Checks that the parallel OBJ parse gives exactly the sequential result.
+// The generated file is several chunks long at four threads and uses
+// groups, materials, quads, v/vt/vn corners and negative indices that reach
+// back across chunk boundaries. A second file with an index past the end
+// must fail in both modes.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gloo/ThreadPool.hpp"
+#include "gloo/parsers/ObjParser.hpp"
+
+using namespace GLOO;
+
+namespace {
+const char* kFileName = "obj_parser_parallel_test.obj";
+const char* kBadFileName = "obj_parser_parallel_test_bad.obj";
+const int kNumBlocks = 40000;
+const int kBlocksPerGroup = 500;
+
+// Each block adds four positions, three texture coordinates and two
+// normals, then faces that refer to them and to the block before it.
+void WriteBlock(std::ofstream& file, int block) {
+  char line[160];
+  for (int k = 0; k < 4; k++) {
+    snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", 0.001f * block,
+             0.25f * k, -0.5f * float(block % 7));
+    file << line;
+  }
+  for (int k = 0; k < 3; k++) {
+    snprintf(line, sizeof(line), "vt %.4f %.4f\n", 0.3f * k,
+             float(block % 11) / 11.f);
+    file << line;
+  }
+  file << "vn 0 1 0\nvn 0.6 0 -0.8\n";
+
+  // OBJ indices start at 1.
+  int v = 4 * block + 1;
+  int vt = 3 * block + 1;
+  int vn = 2 * block + 1;
+  // A quad with absolute v/vt/vn corners.
+  snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", v,
+           vt, vn, v + 1, vt + 1, vn, v + 2, vt + 2, vn + 1, v + 3, vt, vn + 1);
+  file << line;
+  // A quad with relative corners, some without a texture coordinate.
+  file << "f -4//-2 -3//-1 -2/-1/-1 -1/-2/-2\n";
+  if (block > 0) {
+    // A triangle reaching back into the previous block.
+    file << "f -6/-4/-3 -5/-5/-4 -1/-1/-1\n";
+    // And one with absolute indices into it.
+    snprintf(line, sizeof(line), "f %d %d %d\n", v - 4, v - 1, v);
+    file << line;
+  }
+}
+
+bool WriteFile() {
+  std::ofstream file(kFileName);
+  for (int block = 0; block < kNumBlocks; block++) {
+    if (block % kBlocksPerGroup == 0) {
+      int group = block / kBlocksPerGroup;
+      file << "g group" << group << "\n";
+      file << "usemtl material" << group % 3 << "\n";
+    }
+    WriteBlock(file, block);
+  }
+  return bool(file);
+}
+
+bool WriteBadFile() {
+  std::ofstream file(kBadFileName);
+  for (int block = 0; block < kNumBlocks; block++) {
+    WriteBlock(file, block);
+  }
+  // Refers to a position that is never defined.
+  file << "f 1 2 " << 4 * kNumBlocks + 1 << "\n";
+  return bool(file);
+}
+
+template <class T>
+bool SameArray(const std::unique_ptr<std::vector<T>>& a,
+               const std::unique_ptr<std::vector<T>>& b) {
+  if (a == nullptr || b == nullptr)
+    return a == b;
+  return *a == *b;
+}
+
+bool SameGroups(const std::vector<MeshGroup>& a,
+                const std::vector<MeshGroup>& b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].name != b[i].name || a[i].material_name != b[i].material_name ||
+        a[i].start_face_index != b[i].start_face_index ||
+        a[i].num_indices != b[i].num_indices) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int Check(bool condition, const char* what) {
+  std::printf("%s: %s\n", what, condition ? "ok" : "FAILED");
+  return condition ? 0 : 1;
+}
+}  // namespace
+
+int main() {
+  // Chunks are only split off with more than one thread.
+  ThreadPool::GetInstance().SetNumThreads(4);
+
+  if (!WriteFile() || !WriteBadFile()) {
+    std::fprintf(stderr, "Cannot write the test files!\n");
+    return EXIT_FAILURE;
+  }
+
+  bool sequential_success = false;
+  bool parallel_success = false;
+  ObjParser::ParsedData sequential = ObjParser::Parse(
+      kFileName, sequential_success, ObjParser::ParseMode::Sequential);
+  ObjParser::ParsedData parallel = ObjParser::Parse(
+      kFileName, parallel_success, ObjParser::ParseMode::Parallel);
+
+  int failures = 0;
+  failures += Check(sequential_success && parallel_success, "parse");
+  failures += Check(sequential.indices != nullptr &&
+                        sequential.indices->size() > 0 &&
+                        sequential.groups.size() > 1,
+                    "non-empty mesh");
+  failures += Check(SameArray(sequential.positions, parallel.positions),
+                    "positions");
+  failures +=
+      Check(SameArray(sequential.normals, parallel.normals), "normals");
+  failures += Check(SameArray(sequential.tex_coords, parallel.tex_coords),
+                    "tex_coords");
+  failures +=
+      Check(SameArray(sequential.indices, parallel.indices), "indices");
+  failures += Check(SameGroups(sequential.groups, parallel.groups), "groups");
+
+  ObjParser::Parse(kBadFileName, sequential_success,
+                   ObjParser::ParseMode::Sequential);
+  ObjParser::Parse(kBadFileName, parallel_success,
+                   ObjParser::ParseMode::Parallel);
+  failures += Check(!sequential_success && !parallel_success,
+                    "out-of-range index rejected");
+
+  std::remove(kFileName);
+  std::remove(kBadFileName);
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
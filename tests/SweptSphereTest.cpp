@@ -0,0 +1,93 @@
+// Checks SweepSphereTriangle against contacts worked out by hand: a sphere
+// of radius 0.1 swept at unit speed towards the triangle (0,0,0), (1,0,0),
+// (0,1,0) in the z = 0 plane, first touching the face, an edge or a vertex,
+// missing it, or overlapping it from the start.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <glm/glm.hpp>
+
+#include "SweptSphere.hpp"
+
+using namespace GLOO;
+
+namespace {
+const glm::vec3 kA(0.f, 0.f, 0.f);
+const glm::vec3 kB(1.f, 0.f, 0.f);
+const glm::vec3 kC(0.f, 1.f, 0.f);
+const float kRadius = 0.1f;
+const float kEpsilon = 1e-5f;
+
+bool Near(const glm::vec3& a, const glm::vec3& b) {
+  return glm::length(a - b) < kEpsilon;
+}
+
+int CheckHit(const char* what,
+             const glm::vec3& center,
+             const glm::vec3& velocity,
+             float max_time,
+             float time,
+             const glm::vec3& point,
+             const glm::vec3& normal) {
+  SweptSphereHit hit;
+  bool found = SweepSphereTriangle(center, kRadius, velocity, max_time, kA, kB,
+                                   kC, hit);
+  bool ok = found && std::abs(hit.time - time) < kEpsilon &&
+            Near(hit.point, point) && Near(hit.normal, normal);
+  std::printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+  if (found && !ok) {
+    std::printf("  time %f, point (%f, %f, %f), normal (%f, %f, %f)\n",
+                hit.time, hit.point.x, hit.point.y, hit.point.z, hit.normal.x,
+                hit.normal.y, hit.normal.z);
+  }
+  return ok ? 0 : 1;
+}
+
+int CheckMiss(const char* what,
+              const glm::vec3& center,
+              const glm::vec3& velocity,
+              float max_time) {
+  SweptSphereHit hit;
+  bool found = SweepSphereTriangle(center, kRadius, velocity, max_time, kA, kB,
+                                   kC, hit);
+  std::printf("%s: %s\n", what, found ? "FAILED" : "ok");
+  return found ? 1 : 0;
+}
+}  // namespace
+
+int main() {
+  int failures = 0;
+
+  // Falls onto the face and touches it once the center is kRadius above it.
+  failures += CheckHit("face", glm::vec3(0.25f, 0.25f, 1.f),
+                       glm::vec3(0.f, 0.f, -1.f), 2.f, 0.9f,
+                       glm::vec3(0.25f, 0.25f, 0.f), glm::vec3(0.f, 0.f, 1.f));
+
+  // Moves parallel to the plane, 0.06 above it, across the edge (a, b).
+  // Contact is when the center is 0.08 short of the edge.
+  failures += CheckHit("edge", glm::vec3(0.5f, -1.f, 0.06f),
+                       glm::vec3(0.f, 1.f, 0.f), 2.f, 0.92f,
+                       glm::vec3(0.5f, 0.f, 0.f), glm::vec3(0.f, -0.8f, 0.6f));
+
+  // Moves along the line of the edge (a, b) but 0.06 away from it, so that
+  // only vertex a is touched, when the center is 0.08 short of it.
+  failures += CheckHit("vertex", glm::vec3(-1.f, -0.036f, 0.048f),
+                       glm::vec3(1.f, 0.f, 0.f), 2.f, 0.92f, kA,
+                       glm::vec3(-0.8f, -0.36f, 0.48f));
+
+  // Falls past the triangle beyond the edge (b, c).
+  failures += CheckMiss("miss beside", glm::vec3(2.f, 2.f, 1.f),
+                        glm::vec3(0.f, 0.f, -1.f), 2.f);
+  // Would touch the face at 0.9, after the sweep ends.
+  failures += CheckMiss("miss too short", glm::vec3(0.25f, 0.25f, 1.f),
+                        glm::vec3(0.f, 0.f, -1.f), 0.5f);
+
+  // Already closer than kRadius to the face.
+  failures += CheckHit("initial overlap", glm::vec3(0.25f, 0.25f, 0.05f),
+                       glm::vec3(1.f, 0.f, 0.f), 1.f, 0.f,
+                       glm::vec3(0.25f, 0.25f, 0.f), glm::vec3(0.f, 0.f, 1.f));
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}